@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "AliasTable.h"
+
+using namespace UnrealDrive;
+
+void FAliasTable::Reset()
+{
+	Probabilities.Reset();
+	Aliases.Reset();
+	TotalWeight = 0.0;
+}
+
+void FAliasTable::Build(TConstArrayView<double> Weights)
+{
+	Reset();
+
+	const int NumItems = Weights.Num();
+	for (double Weight : Weights)
+	{
+		TotalWeight += FMath::Max(Weight, 0.0);
+	}
+	if (NumItems == 0 || TotalWeight <= 0.0)
+	{
+		TotalWeight = 0.0;
+		return;
+	}
+
+	Probabilities.SetNumUninitialized(NumItems);
+	Aliases.SetNumUninitialized(NumItems);
+
+	TArray<int> Small;
+	TArray<int> Large;
+	Small.Reserve(NumItems);
+	Large.Reserve(NumItems);
+
+	const double Scale = NumItems / TotalWeight;
+	for (int i = 0; i < NumItems; ++i)
+	{
+		Probabilities[i] = FMath::Max(Weights[i], 0.0) * Scale;
+		Aliases[i] = i;
+		(Probabilities[i] < 1.0 ? Small : Large).Add(i);
+	}
+
+	while (Small.Num() && Large.Num())
+	{
+		const int Less = Small.Pop(EAllowShrinking::No);
+		const int More = Large.Last();
+		Aliases[Less] = More;
+		Probabilities[More] -= 1.0 - Probabilities[Less];
+		if (Probabilities[More] < 1.0)
+		{
+			Large.Pop(EAllowShrinking::No);
+			Small.Add(More);
+		}
+	}
+
+	// Rounding leftovers
+	for (int Index : Large)
+	{
+		Probabilities[Index] = 1.0;
+	}
+	for (int Index : Small)
+	{
+		Probabilities[Index] = 1.0;
+	}
+}
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "BakedRoadNetwork.h"
+#include "RoadSplineComponent.h"
+#include "RoadLaneGraph.h"
+#include "DefaultRoadLaneAttributes.h"
+#include "UnrealDrive.h"
+#include "Engine/World.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/Crc.h"
+#include "UObject/UObjectIterator.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+using namespace UnrealDrive::BakedRoadNetwork;
+
+static_assert(sizeof(FHeader) % 8 == 0 && sizeof(FRoad) % 8 == 0 && sizeof(FSample) % 8 == 0 && sizeof(FLane) % 8 == 0, "Baked road network blocks must be 8 bytes aligned");
+
+namespace BakedRoadNetworkUtils
+{
+	static constexpr double SampleTolerance = 0.01; // [cm]
+
+	/** Components of the worlds loaded for the cooking aren't registered, so their ComponentToWorld isn't updated */
+	static FTransform GetComponentToWorld(const USceneComponent* Component)
+	{
+		if (Component->IsRegistered())
+		{
+			return Component->GetComponentTransform();
+		}
+
+		FTransform Transform = Component->GetRelativeTransform();
+		for (const USceneComponent* Parent = Component->GetAttachParent(); Parent; Parent = Parent->GetAttachParent())
+		{
+			Transform = Transform * Parent->GetRelativeTransform();
+		}
+		return Transform;
+	}
+
+	static FVector ToVector(const float V[3])
+	{
+		return FVector(V[0], V[1], V[2]);
+	}
+
+	static void FromVector(const FVector& V, float OutV[3])
+	{
+		OutV[0] = float(V.X);
+		OutV[1] = float(V.Y);
+		OutV[2] = float(V.Z);
+	}
+
+	template<typename T>
+	static uint64 AppendBlock(TArray<uint8>& OutData, const TArray<T>& Block)
+	{
+		const uint64 Offset = Align(uint64(OutData.Num()), uint64(8));
+		OutData.SetNumZeroed(int(Offset + Block.Num() * sizeof(T)));
+		if (Block.Num())
+		{
+			FMemory::Memcpy(OutData.GetData() + Offset, Block.GetData(), Block.Num() * sizeof(T));
+		}
+		return Offset;
+	}
+
+	template<typename T>
+	static bool GetBlock(const uint8* Data, int64 Size, uint64 Offset, uint32 Num, TConstArrayView<T>& OutBlock)
+	{
+		if (Offset % 8 != 0 || Offset > uint64(Size) || uint64(Num) * sizeof(T) > uint64(Size) - Offset)
+		{
+			return false;
+		}
+		OutBlock = MakeArrayView(reinterpret_cast<const T*>(Data + Offset), int(Num));
+		return true;
+	}
+
+	static bool IsRangeValid(uint32 First, uint32 Num, int Size)
+	{
+		return uint64(First) + uint64(Num) <= uint64(Size);
+	}
+}
+
+using namespace BakedRoadNetworkUtils;
+
+//----------------------------------------------------------------------------------------
+void FRoadNetworkBaker::Bake(TConstArrayView<const URoadSplineComponent*> RoadSplines, TArray<uint8>& OutData, double SampleStep)
+{
+	SampleStep = FMath::Max(SampleStep, 1.0);
+
+	FRoadLaneGraph LaneGraph;
+	LaneGraph.Update(RoadSplines);
+
+	TArray<FRoad> Roads;
+	TArray<FLane> Lanes;
+	TArray<FSample> Samples;
+	TArray<FBorder> Borders;
+	TArray<FSpeedSpan> SpeedSpans;
+	TArray<uint32> Edges;
+	TMap<const URoadSplineComponent*, int> RoadIndices;
+
+	for (const URoadSplineComponent* RoadSpline : RoadSplines)
+	{
+		const FRoadLayout& Layout = RoadSpline->GetRoadLayout();
+		const double Length = RoadSpline->GetSplineLength();
+
+		// Regular samples and all section and lane ends, so each lane starts and ends exactly at a sample
+		TArray<double> SValues;
+		for (double S = 0; S < Length; S += SampleStep)
+		{
+			SValues.Add(S);
+		}
+		SValues.Add(Length);
+		for (const FRoadLaneSection& Section : Layout.Sections)
+		{
+			SValues.Add(FMath::Clamp(Section.SOffset, 0.0, Length));
+			SValues.Add(FMath::Clamp(Section.SOffsetEnd_Cashed, 0.0, Length));
+			for (const FRoadLane& Lane : Section.Right)
+			{
+				SValues.Add(FMath::Clamp(Lane.GetEndOffset(), 0.0, Length));
+			}
+			for (const FRoadLane& Lane : Section.Left)
+			{
+				SValues.Add(FMath::Clamp(Lane.GetEndOffset(), 0.0, Length));
+			}
+		}
+		Algo::Sort(SValues);
+
+		const FTransform Transform = GetComponentToWorld(RoadSpline);
+
+		RoadIndices.Add(RoadSpline, Roads.Num());
+		FRoad& Road = Roads.AddZeroed_GetRef();
+		Road.Location[0] = Transform.GetLocation().X;
+		Road.Location[1] = Transform.GetLocation().Y;
+		Road.Location[2] = Transform.GetLocation().Z;
+		Road.Rotation[0] = Transform.GetRotation().X;
+		Road.Rotation[1] = Transform.GetRotation().Y;
+		Road.Rotation[2] = Transform.GetRotation().Z;
+		Road.Rotation[3] = Transform.GetRotation().W;
+		Road.Scale[0] = Transform.GetScale3D().X;
+		Road.Scale[1] = Transform.GetScale3D().Y;
+		Road.Scale[2] = Transform.GetScale3D().Z;
+		Road.Length = Length;
+		Road.PathNameHash = FCrc::StrCrc32(*RoadSpline->GetPathName());
+		Road.FirstSample = Samples.Num();
+
+		for (int i = 0; i < SValues.Num(); ++i)
+		{
+			if (i > 0 && SValues[i] - Samples.Last().S < SampleTolerance)
+			{
+				continue;
+			}
+
+			const float Param = RoadSpline->GetInputKeyValueAtDistanceAlongSpline(SValues[i]);
+			const FQuat Quat = RoadSpline->GetQuaternionAtSplineInputKey(Param, ESplineCoordinateSpace::Local);
+
+			FSample& Sample = Samples.AddZeroed_GetRef();
+			Sample.S = SValues[i];
+			FromVector(RoadSpline->GetLocationAtSplineInputKey(Param, ESplineCoordinateSpace::Local), Sample.Location);
+			FromVector(Quat.GetRightVector(), Sample.Right);
+			FromVector(Quat.GetUpVector(), Sample.Up);
+		}
+		Road.NumSamples = Samples.Num() - Road.FirstSample;
+	}
+
+	// The graph nodes are grouped by the road splines in the same order
+	for (int NodeIndex = 0; NodeIndex < LaneGraph.NumNodes(); ++NodeIndex)
+	{
+		const FRoadLaneGraph::FNode& Node = LaneGraph.GetNode(NodeIndex);
+		const int RoadIndex = RoadIndices[Node.RoadSpline];
+		FRoad& Road = Roads[RoadIndex];
+		if (Road.NumLanes == 0)
+		{
+			Road.FirstLane = Lanes.Num();
+		}
+		++Road.NumLanes;
+
+		const FRoadLayout& Layout = Node.RoadSpline->GetRoadLayout();
+		const FRoadLaneSection& Section = Layout.Sections[Node.SectionIndex];
+		const FRoadLane& Lane = Section.GetLaneByIndex(Node.LaneIndex);
+
+		const TConstArrayView<FSample> RoadSamples = MakeArrayView(Samples.GetData() + Road.FirstSample, Road.NumSamples);
+		auto GetS = [](const FSample& Sample) { return Sample.S; };
+		const int FirstSample = FMath::Clamp(Algo::LowerBoundBy(RoadSamples, Node.SOffset0 - SampleTolerance, GetS), 0, RoadSamples.Num() - 1);
+		const int LastSample = FMath::Clamp(Algo::UpperBoundBy(RoadSamples, Node.SOffset1 + SampleTolerance, GetS) - 1, FirstSample, RoadSamples.Num() - 1);
+
+		FLane& BakedLane = Lanes.AddZeroed_GetRef();
+		BakedLane.S0 = Node.SOffset0;
+		BakedLane.S1 = Node.SOffset1;
+		BakedLane.TravelTime = float(Node.TravelTime);
+		BakedLane.RoadIndex = RoadIndex;
+		BakedLane.SectionIndex = Node.SectionIndex;
+		BakedLane.LaneIndex = Node.LaneIndex;
+		BakedLane.bIsForward = Node.bIsForward;
+		BakedLane.FirstSample = Road.FirstSample + FirstSample;
+		BakedLane.NumSamples = LastSample - FirstSample + 1;
+
+		BakedLane.FirstBorder = Borders.Num();
+		for (int i = FirstSample; i <= LastSample; ++i)
+		{
+			const double S = RoadSamples[i].S;
+			const double ROffset = Layout.EvalROffset(S);
+			FBorder& Border = Borders.AddZeroed_GetRef();
+			Border.Inner = float(Section.EvalLaneROffset(Node.LaneIndex, S, 0.0) + ROffset);
+			Border.Outer = float(Section.EvalLaneROffset(Node.LaneIndex, S, 1.0) + ROffset);
+		}
+
+		BakedLane.FirstSpeedSpan = SpeedSpans.Num();
+		const double DefaultSpeed = FRoadLaneGraph::GetDefaultSpeed();
+		const FRoadLaneAttribute* SpeedAttribute = Lane.Attributes.Find(UnrealDrive::LaneAttributes::Speed);
+		const TArray<FRoadLaneAttributeKey>* SpeedKeys = (SpeedAttribute && SpeedAttribute->GetScriptStruct() == FRaodLaneSpeed::StaticStruct()) ? &SpeedAttribute->Keys : nullptr;
+		if (!SpeedKeys || SpeedKeys->Num() == 0 || (*SpeedKeys)[0].SOffset > SampleTolerance)
+		{
+			SpeedSpans.Add({ 0.0f, float(DefaultSpeed) });
+		}
+		if (SpeedKeys)
+		{
+			for (const FRoadLaneAttributeKey& Key : *SpeedKeys)
+			{
+				const FRaodLaneSpeed* Speed = Key.GetValuePtr<FRaodLaneSpeed>();
+				SpeedSpans.Add({ float(FMath::Max(Key.SOffset, 0.0)), float((Speed && Speed->MaxSpeed > UE_KINDA_SMALL_NUMBER) ? Speed->MaxSpeed * 100.0 : DefaultSpeed) });
+			}
+		}
+		BakedLane.NumSpeedSpans = SpeedSpans.Num() - BakedLane.FirstSpeedSpan;
+
+		BakedLane.FirstEdge = Edges.Num();
+		for (int Successor : LaneGraph.GetSuccessors(NodeIndex))
+		{
+			Edges.Add(Successor);
+		}
+		BakedLane.NumEdges = Edges.Num() - BakedLane.FirstEdge;
+	}
+
+	OutData.Reset();
+	OutData.SetNumZeroed(sizeof(FHeader));
+
+	FHeader Header{};
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.NumRoads = Roads.Num();
+	Header.NumLanes = Lanes.Num();
+	Header.NumSamples = Samples.Num();
+	Header.NumBorders = Borders.Num();
+	Header.NumSpeedSpans = SpeedSpans.Num();
+	Header.NumEdges = Edges.Num();
+	Header.RoadsOffset = AppendBlock(OutData, Roads);
+	Header.LanesOffset = AppendBlock(OutData, Lanes);
+	Header.SamplesOffset = AppendBlock(OutData, Samples);
+	Header.BordersOffset = AppendBlock(OutData, Borders);
+	Header.SpeedSpansOffset = AppendBlock(OutData, SpeedSpans);
+	Header.EdgesOffset = AppendBlock(OutData, Edges);
+	Header.TotalSize = OutData.Num();
+	FMemory::Memcpy(OutData.GetData(), &Header, sizeof(FHeader));
+}
+
+bool FRoadNetworkBaker::BakeWorld(const UWorld* World, double SampleStep)
+{
+	check(World);
+
+	TArray<const URoadSplineComponent*> RoadSplines;
+	for (TObjectIterator<URoadSplineComponent> It; It; ++It)
+	{
+		if (IsValid(*It) && !It->IsTemplate() && It->GetWorld() == World)
+		{
+			RoadSplines.Add(*It);
+		}
+	}
+
+	// Deterministic output
+	Algo::SortBy(RoadSplines, [](const URoadSplineComponent* RoadSpline) { return RoadSpline->GetPathName(); });
+
+	TArray<uint8> Data;
+	Bake(RoadSplines, Data, SampleStep);
+
+	const FString FileName = FPaths::ProjectDir() / FBakedRoadNetwork::GetBakedFileName(World);
+	if (!FFileHelper::SaveArrayToFile(Data, *FileName))
+	{
+		UE_LOG(LogUnrealDrive, Error, TEXT("FRoadNetworkBaker::BakeWorld(); Can't save \"%s\""), *FileName);
+		return false;
+	}
+
+	UE_LOG(LogUnrealDrive, Log, TEXT("FRoadNetworkBaker::BakeWorld(); Baked %i road splines to \"%s\" (%i bytes)"), RoadSplines.Num(), *FileName, Data.Num());
+	return true;
+}
+
+//----------------------------------------------------------------------------------------
+FBakedRoadNetwork::FBakedRoadNetwork()
+{
+}
+
+FBakedRoadNetwork::~FBakedRoadNetwork()
+{
+	Close();
+}
+
+FString FBakedRoadNetwork::GetBakedFileName(const UWorld* World)
+{
+	FString PackageName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	PackageName.RemoveFromStart(TEXT("/"));
+	return FPaths::Combine(TEXT("Content/UnrealDrive/BakedRoadNetworks"), PackageName + TEXT(".udrn"));
+}
+
+void FBakedRoadNetwork::Close()
+{
+	Header = nullptr;
+	Roads = {};
+	Lanes = {};
+	Samples = {};
+	Borders = {};
+	SpeedSpans = {};
+	Edges = {};
+
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	LoadedData.Empty();
+}
+
+bool FBakedRoadNetwork::Open(const FString& FileName)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FOpenMappedResult MappedResult = PlatformFile.OpenMappedEx(*FileName);
+	if (MappedResult.HasValue())
+	{
+		MappedFile = MappedResult.StealValue();
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		Size = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		MappedFile.Reset();
+		if (!FFileHelper::LoadFileToArray(LoadedData, *FileName))
+		{
+			UE_LOG(LogUnrealDrive, Error, TEXT("FBakedRoadNetwork::Open(); Can't open \"%s\""), *FileName);
+			return false;
+		}
+		Data = LoadedData.GetData();
+		Size = LoadedData.Num();
+	}
+
+	if (!Validate(Data, Size))
+	{
+		UE_LOG(LogUnrealDrive, Error, TEXT("FBakedRoadNetwork::Open(); \"%s\" is broken or has unsupported version"), *FileName);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+bool FBakedRoadNetwork::Validate(const uint8* Data, int64 Size)
+{
+	if (Size < int64(sizeof(FHeader)))
+	{
+		return false;
+	}
+
+	const FHeader* InHeader = reinterpret_cast<const FHeader*>(Data);
+	if (InHeader->Magic != Magic || InHeader->Version != Version || InHeader->TotalSize > uint64(Size))
+	{
+		return false;
+	}
+
+	if (!GetBlock(Data, Size, InHeader->RoadsOffset, InHeader->NumRoads, Roads) ||
+		!GetBlock(Data, Size, InHeader->LanesOffset, InHeader->NumLanes, Lanes) ||
+		!GetBlock(Data, Size, InHeader->SamplesOffset, InHeader->NumSamples, Samples) ||
+		!GetBlock(Data, Size, InHeader->BordersOffset, InHeader->NumBorders, Borders) ||
+		!GetBlock(Data, Size, InHeader->SpeedSpansOffset, InHeader->NumSpeedSpans, SpeedSpans) ||
+		!GetBlock(Data, Size, InHeader->EdgesOffset, InHeader->NumEdges, Edges))
+	{
+		return false;
+	}
+
+	// Check all indices once, so the queries don't need to
+	for (int RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex)
+	{
+		const FRoad& Road = Roads[RoadIndex];
+		if (!IsRangeValid(Road.FirstSample, Road.NumSamples, Samples.Num()) || !IsRangeValid(Road.FirstLane, Road.NumLanes, Lanes.Num()))
+		{
+			return false;
+		}
+		for (uint32 LaneIndex = Road.FirstLane; LaneIndex < Road.FirstLane + Road.NumLanes; ++LaneIndex)
+		{
+			if (Lanes[LaneIndex].RoadIndex != uint32(RoadIndex))
+			{
+				return false;
+			}
+		}
+	}
+	for (const FLane& Lane : Lanes)
+	{
+		if (Lane.RoadIndex >= uint32(Roads.Num()) || Lane.NumSamples == 0 || Lane.NumSpeedSpans == 0 ||
+			!IsRangeValid(Lane.FirstSample, Lane.NumSamples, Samples.Num()) ||
+			!IsRangeValid(Lane.FirstBorder, Lane.NumSamples, Borders.Num()) ||
+			!IsRangeValid(Lane.FirstSpeedSpan, Lane.NumSpeedSpans, SpeedSpans.Num()) ||
+			!IsRangeValid(Lane.FirstEdge, Lane.NumEdges, Edges.Num()))
+		{
+			return false;
+		}
+	}
+	for (uint32 Edge : Edges)
+	{
+		if (Edge >= uint32(Lanes.Num()))
+		{
+			return false;
+		}
+	}
+
+	Header = InHeader;
+	return true;
+}
+
+TConstArrayView<uint32> FBakedRoadNetwork::GetSuccessors(int LaneIndex) const
+{
+	const FLane& Lane = Lanes[LaneIndex];
+	return Edges.Slice(Lane.FirstEdge, Lane.NumEdges);
+}
+
+int FBakedRoadNetwork::FindRoad(uint32 PathNameHash) const
+{
+	return Roads.IndexOfByPredicate([PathNameHash](const FRoad& Road) { return Road.PathNameHash == PathNameHash; });
+}
+
+FTransform FBakedRoadNetwork::EvalLaneTransform(int LaneIndex, double S, double Alpha) const
+{
+	const FLane& Lane = Lanes[LaneIndex];
+	const FRoad& Road = Roads[Lane.RoadIndex];
+	const TConstArrayView<FSample> LaneSamples = Samples.Slice(Lane.FirstSample, Lane.NumSamples);
+	const TConstArrayView<FBorder> LaneBorders = Borders.Slice(Lane.FirstBorder, Lane.NumSamples);
+
+	S = FMath::Clamp(S, Lane.S0, Lane.S1);
+
+	int Index0 = 0;
+	int Index1 = 0;
+	double T = 0;
+	if (LaneSamples.Num() > 1)
+	{
+		Index0 = FMath::Clamp(Algo::UpperBoundBy(LaneSamples, S, [](const FSample& Sample) { return Sample.S; }) - 1, 0, LaneSamples.Num() - 2);
+		Index1 = Index0 + 1;
+		const double Diff = LaneSamples[Index1].S - LaneSamples[Index0].S;
+		T = Diff > 0 ? FMath::Clamp((S - LaneSamples[Index0].S) / Diff, 0.0, 1.0) : 0.0;
+	}
+
+	const FSample& Sample0 = LaneSamples[Index0];
+	const FSample& Sample1 = LaneSamples[Index1];
+	const FVector Right = FMath::Lerp(ToVector(Sample0.Right), ToVector(Sample1.Right), T).GetSafeNormal();
+	const FVector Up = FMath::Lerp(ToVector(Sample0.Up), ToVector(Sample1.Up), T).GetSafeNormal();
+	const double Inner = FMath::Lerp(LaneBorders[Index0].Inner, LaneBorders[Index1].Inner, T);
+	const double Outer = FMath::Lerp(LaneBorders[Index0].Outer, LaneBorders[Index1].Outer, T);
+	const FVector Location = FMath::Lerp(ToVector(Sample0.Location), ToVector(Sample1.Location), T) + Right * FMath::Lerp(Inner, Outer, Alpha);
+
+	const FTransform LocalTransform(FRotationMatrix::MakeFromYZ(Right, Up).ToQuat(), Location);
+	const FTransform RoadTransform(
+		FQuat(Road.Rotation[0], Road.Rotation[1], Road.Rotation[2], Road.Rotation[3]),
+		FVector(Road.Location[0], Road.Location[1], Road.Location[2]),
+		FVector(Road.Scale[0], Road.Scale[1], Road.Scale[2]));
+	return LocalTransform * RoadTransform;
+}
+
+double FBakedRoadNetwork::EvalSpeedLimit(int LaneIndex, double S) const
+{
+	const FLane& Lane = Lanes[LaneIndex];
+	const TConstArrayView<FSpeedSpan> LaneSpans = SpeedSpans.Slice(Lane.FirstSpeedSpan, Lane.NumSpeedSpans);
+	const double LocalS = FMath::Clamp(S, Lane.S0, Lane.S1) - Lane.S0;
+	const int SpanIndex = FMath::Max(Algo::UpperBoundBy(LaneSpans, LocalS, [](const FSpeedSpan& Span) { return double(Span.S0); }) - 1, 0);
+	return LaneSpans[SpanIndex].Speed;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "BoxBVH.h"
+#include "Algo/Sort.h"
+
+using namespace UnrealDrive;
+
+void FBoxBVH::Reset()
+{
+	Nodes.Reset();
+	ItemIndices.Reset();
+	ItemBounds.Reset();
+}
+
+void FBoxBVH::Build(TConstArrayView<FBox> InItemBounds, int MaxLeafSize)
+{
+	Reset();
+
+	const int NumItems = InItemBounds.Num();
+	if (NumItems == 0)
+	{
+		return;
+	}
+
+	MaxLeafSize = FMath::Max(1, MaxLeafSize);
+	ItemBounds = InItemBounds;
+	ItemIndices.SetNumUninitialized(NumItems);
+	for (int i = 0; i < NumItems; ++i)
+	{
+		ItemIndices[i] = i;
+	}
+
+	Nodes.Reserve(2 * (NumItems / MaxLeafSize) + 1);
+	Nodes.Add({ FBox(ForceInit), 0, NumItems });
+
+	TArray<int, TInlineAllocator<64>> Stack;
+	Stack.Push(0);
+	while (Stack.Num())
+	{
+		const int NodeIndex = Stack.Pop(EAllowShrinking::No);
+		const int First = Nodes[NodeIndex].First;
+		const int Count = Nodes[NodeIndex].Count;
+
+		FBox Bounds(ForceInit);
+		FBox CenterBounds(ForceInit);
+		for (int i = First; i < First + Count; ++i)
+		{
+			const FBox& Box = ItemBounds[ItemIndices[i]];
+			Bounds += Box;
+			CenterBounds += Box.GetCenter();
+		}
+		Nodes[NodeIndex].Bounds = Bounds;
+
+		if (Count <= MaxLeafSize)
+		{
+			continue;
+		}
+
+		const FVector Extent = CenterBounds.GetExtent();
+		const int Axis = (Extent.X >= Extent.Y && Extent.X >= Extent.Z) ? 0 : (Extent.Y >= Extent.Z ? 1 : 2);
+		Algo::Sort(MakeArrayView(ItemIndices.GetData() + First, Count), [this, Axis](int A, int B)
+		{
+			return ItemBounds[A].GetCenter()[Axis] < ItemBounds[B].GetCenter()[Axis];
+		});
+
+		const int LeftCount = Count / 2;
+		const int LeftIndex = Nodes.Num();
+		Nodes.Add({ FBox(ForceInit), First, LeftCount });
+		Nodes.Add({ FBox(ForceInit), First + LeftCount, Count - LeftCount });
+
+		Nodes[NodeIndex].First = LeftIndex;
+		Nodes[NodeIndex].Count = 0;
+
+		Stack.Push(LeftIndex);
+		Stack.Push(LeftIndex + 1);
+	}
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "CompiledCurve.h"
+
+using namespace UnrealDrive;
+
+void FCompiledCurve::Reset()
+{
+	Breakpoints.Reset();
+	Spans.Reset();
+	PreValue = 0;
+	PostValue = 0;
+	bIsCompiled = false;
+}
+
+void FCompiledCurve::Compile(const FRichCurve& Curve)
+{
+	Reset();
+
+	auto IsConstantExtrap = [](ERichCurveExtrapolation Extrap)
+	{
+		return Extrap == RCCE_Constant || Extrap == RCCE_None;
+	};
+
+	if (!IsConstantExtrap(Curve.PreInfinityExtrap) || !IsConstantExtrap(Curve.PostInfinityExtrap))
+	{
+		return;
+	}
+
+	const TArray<FRichCurveKey>& Keys = Curve.Keys;
+
+	if (Keys.Num() == 0)
+	{
+		// Same as FRichCurve::Eval() with default InDefaultValue
+		PreValue = PostValue = (Curve.DefaultValue == MAX_flt) ? 0.0 : Curve.DefaultValue;
+		bIsCompiled = true;
+		return;
+	}
+
+	PreValue = Keys[0].Value;
+	PostValue = Keys.Last().Value;
+
+	if (Keys.Num() > 1)
+	{
+		Breakpoints.SetNumUninitialized(Keys.Num());
+		Spans.SetNumUninitialized(Keys.Num() - 1);
+
+		for (int i = 0; i < Keys.Num(); ++i)
+		{
+			Breakpoints[i] = Keys[i].Time;
+		}
+
+		for (int i = 0; i < Keys.Num() - 1; ++i)
+		{
+			const FRichCurveKey& Key1 = Keys[i];
+			const FRichCurveKey& Key2 = Keys[i + 1];
+			const double Diff = Key2.Time - Key1.Time;
+			FSpan& Span = Spans[i];
+			Span = FSpan{};
+			Span.C0 = Key1.Value;
+
+			// Mirrors FRichCurve::EvalForTwoKeys()
+			if (Diff <= 0.0 || Key1.InterpMode == RCIM_Constant)
+			{
+				continue;
+			}
+
+			Span.InvDuration = 1.0 / Diff;
+
+			if (Key1.InterpMode == RCIM_Linear)
+			{
+				Span.C1 = Key2.Value - Key1.Value;
+				continue;
+			}
+
+			const bool bIsNotWeighted =
+				(Key1.TangentWeightMode == RCTWM_WeightedNone || Key1.TangentWeightMode == RCTWM_WeightedArrive) &&
+				(Key2.TangentWeightMode == RCTWM_WeightedNone || Key2.TangentWeightMode == RCTWM_WeightedLeave);
+			if (!bIsNotWeighted)
+			{
+				Reset();
+				return;
+			}
+
+			// Bezier control points to the power basis
+			const double P0 = Key1.Value;
+			const double P1 = P0 + Key1.LeaveTangent * Diff / 3.0;
+			const double P3 = Key2.Value;
+			const double P2 = P3 - Key2.ArriveTangent * Diff / 3.0;
+			Span.C1 = 3.0 * (P1 - P0);
+			Span.C2 = 3.0 * (P0 - 2.0 * P1 + P2);
+			Span.C3 = P3 - P0 + 3.0 * (P1 - P2);
+		}
+	}
+
+	bIsCompiled = true;
+}
@@ -24,7 +24,6 @@
 #include "Materials/MaterialInstanceDynamic.h"
 #include "ConstrainedDelaunay2.h"
 #include "Polygon2.h"
-#include "DynamicMesh/DynamicMesh3.h"
 #include "Styling/StyleColors.h"
 
 using namespace UE::Geometry;
@@ -32,50 +31,150 @@ using namespace UnrealDrive;
 
 static const FColor SplineColor = FStyleColors::AccentPink.GetSpecifiedColor().ToFColor(true);
 
-static bool BuildRoadMesh(const TArray<FSplinePositionLinearApproximation>& Side1, const TArray<FSplinePositionLinearApproximation>& Side2, FConstrainedDelaunay2d::EFillRule FillRule, const URoadSplineComponent* Component, int LaneIndex, const FRoadLaneSection& LaneSection, FDynamicMesh3& OutMesh)
+/**
+ * Append the strip of the lane between the Side1 and Side2 to the OutVertices: Side1 rows go first, then Side2 rows. The triangles are stored to the OutIndices.
+ * SOffsets1/2 are the distances along the spline of the side points, see URoadSplineComponent::BuildLinearApproximation()
+ */
+static bool BuildRoadMesh(const TArray<FSplinePositionLinearApproximation>& Side1, TConstArrayView<double> SOffsets1, const TArray<FSplinePositionLinearApproximation>& Side2, TConstArrayView<double> SOffsets2, const URoadSplineComponent* Component, int LaneIndex, const FRoadLaneSection& LaneSection, TArray<FDynamicMeshVertex>& OutVertices, TArray<uint32>& OutIndices)
 {
 	check(Side1.Num() == Side2.Num());
+	check(Side1.Num() == SOffsets1.Num() && Side2.Num() == SOffsets2.Num());
 
 	const int N = Side1.Num();
+	if (N < 2)
+	{
+		return false;
+	}
+
 	const double LaneDefWidth = UnrealDrive::DefaultRoadLaneWidth * 0.8;
+	const FRoadLane& Lane = LaneSection.GetLaneByIndex(LaneIndex);
+	const bool bIsRever = ((LaneIndex < 0) ^ (Lane.Direction == ERoadLaneDirection::Invert) ^ (Component->RoadLayout.Direction == ERoadDirection::RightHand));
+	const double VScale = (bIsRever ? -1.0 : 1.0) / LaneDefWidth;
+
+	const uint32 BaseVertex = OutVertices.Num();
+	OutVertices.AddUninitialized(2 * N);
+	FDynamicMeshVertex* Vertices1 = OutVertices.GetData() + BaseVertex;
+	FDynamicMeshVertex* Vertices2 = Vertices1 + N;
 
 	for (int i = 0; i < N; ++i)
 	{
-		const FRoadLane& Lane = LaneSection.GetLaneByIndex(LaneIndex);
-		const double S = Component->GetDistanceAlongSplineAtSplineInputKey(Side1[i].SplineParam);
-		const double Width = Lane.Width.Eval(S - LaneSection.SOffset);
-		const bool bIsRever = ((LaneIndex < 0) ^ (Lane.Direction == ERoadLaneDirection::Invert) ^ (Component->RoadLayout.Direction == ERoadDirection::RightHand));
-		FVertexInfo Vertex{};
-		Vertex.Position = Side1[i].Position;
-		Vertex.UV = FVector2f(0 - Width / LaneDefWidth / 2 + 0.5, S / LaneDefWidth * (bIsRever ? -1 : 1));
-		Vertex.Color = FVector3f(0.0);
-		Vertex.bHaveC = true;
-		Vertex.bHaveUV = true;
-		OutMesh.AppendVertex(Vertex);
+		const double Width1 = Lane.EvalWidth(SOffsets1[i] - LaneSection.SOffset) / LaneDefWidth;
+		const double Width2 = Lane.EvalWidth(SOffsets2[i] - LaneSection.SOffset) / LaneDefWidth;
+		Vertices1[i] = FDynamicMeshVertex(FVector3f(Side1[i].Position), FVector2f(0 - Width1 / 2 + 0.5, SOffsets1[i] * VScale), FColor::White);
+		Vertices2[i] = FDynamicMeshVertex(FVector3f(Side2[i].Position), FVector2f(Width2 - Width2 / 2 + 0.5, SOffsets2[i] * VScale), FColor::White);
 	}
 
-	for (int i = 0; i < N; ++i)
+	OutIndices.Reset(6 * (N - 1));
+	for (uint32 i = BaseVertex; i < BaseVertex + N - 1; ++i)
+	{
+		OutIndices.Append({ i, i + 1, i + N });
+		OutIndices.Append({ i + N , i + 1, i + 1 + N });
+	}
+
+	return true;
+}
+
+namespace RoadMeshLOD
+{
+	/** Max number of the strip rows merged into one quad of the coarser LOD, bounds the cost of the error check */
+	static constexpr int MaxMergedRows = 64;
+
+	/**
+	 * Rows of the section strips kept by the coarser LOD. The rows are dropped greedily along S while the dropped points of every lane side are within 
+	 * MaxError from the sides of the merged quad. The rows are chosen once for all lanes of the section, so the neighbour lanes share their edge vertices
+	 * in every LOD and there are no T-junction cracks between them
+	 */
+	static void ChooseRows(const TArray<FDynamicMeshVertex>& Vertices, TConstArrayView<uint32> SideBaseVertices, int NumRows, double MaxError, TArray<int>& OutRows)
 	{
-		const FRoadLane& Lane = LaneSection.GetLaneByIndex(LaneIndex);
-		const double S = Component->GetDistanceAlongSplineAtSplineInputKey(Side2[i].SplineParam);
-		const double Width = Lane.Width.Eval(S - LaneSection.SOffset);
-		const bool bIsRever = ((LaneIndex < 0) ^ (Lane.Direction == ERoadLaneDirection::Invert) ^ (Component->RoadLayout.Direction == ERoadDirection::RightHand));
-		FVertexInfo Vertex{};
-		Vertex.Position = Side2[i].Position;
-		Vertex.UV = FVector2f(Width / LaneDefWidth - Width / LaneDefWidth / 2  + 0.5, S / LaneDefWidth * (bIsRever ? -1 : 1));
-		Vertex.Color = FVector3f(0.0);
-		Vertex.bHaveC = true;
-		Vertex.bHaveUV = true;
-		OutMesh.AppendVertex(Vertex);
+		const double MaxErrorSquared = FMath::Square(MaxError);
+
+		auto IsWithinError = [&](int Row0, int Row1)
+		{
+			for (const uint32 Base : SideBaseVertices)
+			{
+				const FVector P0(Vertices[Base + Row0].Position);
+				const FVector P1(Vertices[Base + Row1].Position);
+				for (int i = Row0 + 1; i < Row1; ++i)
+				{
+					if (FMath::PointDistToSegmentSquared(FVector(Vertices[Base + i].Position), P0, P1) > MaxErrorSquared)
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		};
+
+		OutRows.Reset();
+		OutRows.Add(0);
+		for (int Row0 = 0; Row0 < NumRows - 1;)
+		{
+			int Row1 = Row0 + 1;
+			while (Row1 + 1 < NumRows && Row1 + 1 - Row0 <= MaxMergedRows && IsWithinError(Row0, Row1 + 1))
+			{
+				++Row1;
+			}
+			OutRows.Add(Row1);
+			Row0 = Row1;
+		}
 	}
 
-	for (int i = 0; i < N - 1; ++i)
+	/** Triangles of the coarser LOD of the lane strip built by BuildRoadMesh(), the LOD shares the vertices of the full mesh */
+	static void BuildIndices(TConstArrayView<int> Rows, int NumRows, uint32 BaseVertex, TArray<uint32>& OutIndices)
 	{
-		OutMesh.AppendTriangle({ i, i + 1, i + N });
-		OutMesh.AppendTriangle({ i + N , i + 1, i + 1 + N });
+		const uint32 N = NumRows;
+		OutIndices.Reset(6 * (Rows.Num() - 1));
+		for (int i = 0; i < Rows.Num() - 1; ++i)
+		{
+			const uint32 Vertex0 = BaseVertex + Rows[i];
+			const uint32 Vertex1 = BaseVertex + Rows[i + 1];
+			OutIndices.Append({ Vertex0, Vertex1, Vertex0 + N });
+			OutIndices.Append({ Vertex0 + N, Vertex1, Vertex1 + N });
+		}
 	}
 
-	return true;
+	/** Build the coarser LODs of all lanes of the section chunk, each lane strip must have NumRows rows (see BuildLanes()) */
+	static void BuildChunkLODs(FRoadMeshChunk& Chunk, int NumRows)
+	{
+		if (Chunk.NumLODs < 2 || NumRows < 2)
+		{
+			return;
+		}
+
+		auto HasStrip = [NumRows](const FRoadMeshChunk::FLane& Lane)
+		{
+			return Lane.LODIndices[0].Num() && Lane.MaxVertexIndex - Lane.MinVertexIndex + 1 == uint32(2 * NumRows);
+		};
+
+		// Both sides of each lane strip, the shared sides of the neighbour lanes are checked twice
+		TArray<uint32, TInlineAllocator<32>> SideBaseVertices;
+		for (const FRoadMeshChunk::FLane& Lane : Chunk.Lanes)
+		{
+			if (HasStrip(Lane))
+			{
+				SideBaseVertices.Add(Lane.MinVertexIndex);
+				SideBaseVertices.Add(Lane.MinVertexIndex + NumRows);
+			}
+		}
+		if (SideBaseVertices.Num() == 0)
+		{
+			return;
+		}
+
+		const double LODError = GetDefault<UUnrealDriveSettings>()->LaneMeshLODError;
+		TArray<int> Rows;
+		for (int LODIndex = 1; LODIndex < Chunk.NumLODs; ++LODIndex)
+		{
+			ChooseRows(Chunk.Vertices, SideBaseVertices, NumRows, LODError * FMath::Pow(4.0, LODIndex - 1), Rows);
+			for (FRoadMeshChunk::FLane& Lane : Chunk.Lanes)
+			{
+				if (HasStrip(Lane))
+				{
+					BuildIndices(Rows, NumRows, Lane.MinVertexIndex, Lane.LODIndices[LODIndex]);
+				}
+			}
+		}
+	}
 }
 
 static void ConvertSplineToPolyLine(const USplineComponent* SplineComp, TArray<FVector>& OutPoints)
@@ -108,7 +207,29 @@ static void ConvertSplineToPolyLine(const USplineComponent* SplineComp, TArray<F
 }
 
 
-static TSharedPtr<FLaneProxy> MakeLaneProxy(TArray<FSplinePositionLinearApproximation>& PrevPoints, const URoadSplineComponent* Component, int SectionIndex, int LaneIndex, double S0, double S1, bool bDrawStartCap, bool bDrawEndCap, ERHIFeatureLevel::Type FeatureLevel)
+static void AppendLaneMesh(FRoadMeshChunk& Chunk, FRoadMeshChunk::FLane& Lane, const TArray<FDynamicMeshVertex>& Vertices, TConstArrayView<TArray<uint32>> LODIndices)
+{
+	check(LODIndices.Num() <= MaxRoadMeshLODs);
+
+	if (LODIndices.Num() && LODIndices[0].Num() > 3)
+	{
+		const uint32 BaseVertex = Chunk.Vertices.Num();
+		Chunk.Vertices.Append(Vertices);
+		Lane.MinVertexIndex = BaseVertex;
+		Lane.MaxVertexIndex = BaseVertex + Vertices.Num() - 1;
+		for (int LODIndex = 0; LODIndex < LODIndices.Num(); ++LODIndex)
+		{
+			const TArray<uint32>& Indices = LODIndices[LODIndex];
+			Lane.LODIndices[LODIndex].SetNumUninitialized(Indices.Num());
+			for (int i = 0; i < Indices.Num(); ++i)
+			{
+				Lane.LODIndices[LODIndex][i] = Indices[i] + BaseVertex;
+			}
+		}
+	}
+}
+
+static bool MakeLane(TArray<FSplinePositionLinearApproximation>& PrevPoints, TArray<double>& PrevSOffsets, const URoadSplineComponent* Component, int SectionIndex, int LaneIndex, double S0, double S1, bool bDrawStartCap, bool bDrawEndCap, FRoadMeshChunk& Chunk)
 {
 	const int NumPointPerSegmaent = GetDefault<UUnrealDriveSettings>()->NumPointPerSegmaent;
 	const int NumPointPerSection = GetDefault<UUnrealDriveSettings>()->NumPointPerSection;
@@ -118,72 +239,52 @@ static TSharedPtr<FLaneProxy> MakeLaneProxy(TArray<FSplinePositionLinearApproxim
 
 	if ((S1 - S0) < KINDA_SMALL_NUMBER)
 	{
-		return {};
+		return false;
 	}
 
-	auto LaneProxy = MakeShared< FLaneProxy>(SectionIndex, LaneIndex, FeatureLevel);
+	FRoadMeshChunk::FLane& MeshLane = Chunk.Lanes.AddDefaulted_GetRef();
+	MeshLane.SectionIndex = SectionIndex;
+	MeshLane.LaneIndex = LaneIndex;
 
 	TArray<FSplinePositionLinearApproximation> Points;
+	TArray<double> SOffsets;
 	Component->BuildLinearApproximation(Points, [&](double S)
 	{
 		return Section.EvalLaneROffset(LaneIndex, S) + Component->EvalROffset(S);
-	}, S0, S1, NumPointPerSegmaent, NumPointPerSection, ESplineCoordinateSpace::Local);
+	}, S0, S1, NumPointPerSegmaent, NumPointPerSection, ESplineCoordinateSpace::Local, &SOffsets);
 
 	check(Points.Num());
 
-	LaneProxy->LanePoints.Reserve(Points.Num() + 2);
+	MeshLane.LanePoints.Reserve(Points.Num() + 2);
 
 	if (bDrawStartCap)
 	{
-		LaneProxy->LanePoints.Add(PrevPoints[0].Position);
+		MeshLane.LanePoints.Add(PrevPoints[0].Position);
 	}
 	for (const auto& Pt : Points)
 	{
-		LaneProxy->LanePoints.Add(Pt.Position);
+		MeshLane.LanePoints.Add(Pt.Position);
 	}
 	if (bDrawEndCap)
 	{
-		LaneProxy->LanePoints.Add(PrevPoints.Last().Position);
+		MeshLane.LanePoints.Add(PrevPoints.Last().Position);
 	}
 
-	FDynamicMesh3 Mesh(false /*bWantNormals*/, true /* bWantColors*/, true /*bWantUVs*/, false /*bWantTriGroups*/);
-	if (BuildRoadMesh(PrevPoints, Points, LaneIndex >= 0 ? FConstrainedDelaunay2d::EFillRule::Positive : FConstrainedDelaunay2d::EFillRule::Negative, Component, LaneIndex, Section, Mesh))
+	const uint32 BaseVertex = Chunk.Vertices.Num();
+	if (BuildRoadMesh(PrevPoints, PrevSOffsets, Points, SOffsets, Component, LaneIndex, Section, Chunk.Vertices, MeshLane.LODIndices[0]))
 	{
 		UMaterialInstance* Material = UUnrealDriveSettings::GetLaneMatrtial(Section.GetLaneByIndex(LaneIndex).LaneInstance);
 		check(Material);
 
-		LaneProxy->Material = Material->GetRenderProxy();
-
-		TArray<FDynamicMeshVertex> MeshVertices;
-		TArray<uint32> MeshIndices;
-
-		MeshVertices.Reserve(Mesh.VertexCount());
-		MeshIndices.Reserve(3 * Mesh.TriangleCount());
-		for (int VertexIndex : Mesh.VertexIndicesItr())
-		{
-			FVertexInfo VertexInfo;
-			const bool bWantColors = true;
-			const bool bWantNormals = false;
-			const bool bWantUVs = true;
-			Mesh.GetVertex(VertexIndex, VertexInfo, bWantNormals, bWantColors, bWantUVs);
-
-			const FVector3f LocalSpacePosition = FVector3f(VertexInfo.Position);
-			FDynamicMeshVertex MeshVertex(LocalSpacePosition);
-
-			MeshVertex.Color = FColor(255, 255, 255, 255);
-			MeshVertex.TextureCoordinate[0] = VertexInfo.UV;
-			MeshVertices.Add(MeshVertex);
-		}
-		for (FIndex3i Triangle : Mesh.TrianglesItr())
-		{
-			MeshIndices.Append({ (uint32)Triangle.A, (uint32)Triangle.B, (uint32)Triangle.C });
-		}
-		LaneProxy->InitMesh(MeshVertices, MeshIndices);
+		MeshLane.Material = Material->GetRenderProxy();
+		MeshLane.MinVertexIndex = BaseVertex;
+		MeshLane.MaxVertexIndex = Chunk.Vertices.Num() - 1;
 	}
 
 	PrevPoints = MoveTemp(Points);
+	PrevSOffsets = MoveTemp(SOffsets);
 
-	return LaneProxy;
+	return true;
 };
 
 static bool HasLeftSide(ERoadLaneSectionSide Side)
@@ -196,36 +297,332 @@ static bool HasRightSide(ERoadLaneSectionSide Side)
 	return Side == ERoadLaneSectionSide::Both || Side == ERoadLaneSectionSide::Right;
 }
 
+namespace RoadMeshChunk
+{
+	template<typename T>
+	static uint32 HashValue(uint32 Hash, const T& Value)
+	{
+		return FCrc::MemCrc32(&Value, sizeof(T), Hash);
+	}
+
+	template<typename T>
+	static uint32 HashCurvePoint(uint32 Hash, const FInterpCurvePoint<T>& Point)
+	{
+		Hash = HashValue(Hash, Point.InVal);
+		Hash = HashValue(Hash, Point.OutVal);
+		Hash = HashValue(Hash, Point.ArriveTangent);
+		Hash = HashValue(Hash, Point.LeaveTangent);
+		return HashValue(Hash, uint8(Point.InterpMode));
+	}
+
+	static uint32 HashRichCurve(uint32 Hash, const FRichCurve& Curve)
+	{
+		for (const FRichCurveKey& Key : Curve.GetConstRefOfKeys())
+		{
+			Hash = HashValue(Hash, uint8(Key.InterpMode));
+			Hash = HashValue(Hash, uint8(Key.TangentMode));
+			Hash = HashValue(Hash, Key.Time);
+			Hash = HashValue(Hash, Key.Value);
+			Hash = HashValue(Hash, Key.ArriveTangent);
+			Hash = HashValue(Hash, Key.LeaveTangent);
+		}
+		return HashValue(Hash, Curve.DefaultValue);
+	}
+
+	static uint32 HashLanes(uint32 Hash, const FRoadLaneSection& Section, const TArray<FRoadLane>& Lanes)
+	{
+		Hash = HashValue(Hash, Section.SOffset);
+		Hash = HashValue(Hash, Lanes.Num());
+		for (const FRoadLane& Lane : Lanes)
+		{
+			Hash = HashRichCurve(Hash, Lane.Width);
+			Hash = HashValue(Hash, uint8(Lane.Direction));
+			Hash = HashValue(Hash, UUnrealDriveSettings::GetLaneMatrtial(Lane.LaneInstance));
+		}
+		return Hash;
+	}
+
+	static uint32 HashLODs(uint32 Hash, const UUnrealDriveSettings* Settings)
+	{
+		Hash = HashValue(Hash, Settings->LaneMeshLODError);
+		for (float ScreenSize : Settings->LaneMeshLODScreenSizes)
+		{
+			Hash = HashValue(Hash, ScreenSize);
+		}
+		return Hash;
+	}
+
+	/** 
+	 * Hash of everything the section chunk mesh depends on: the spline curves over the section, the lanes of the section (or of the previous sections 
+	 * whose lanes are continued by this section), the side of the next section (lanes caps) and the road wide properties
+	 */
+	static uint32 HashSection(const URoadSplineComponent* Component, int SectionIndex, int RightSectionIndex, int LeftSectionIndex, ERoadLaneSectionSide NextSide)
+	{
+		const FRoadLaneSection& Section = Component->GetLaneSection(SectionIndex);
+		const FRoadLayout& Layout = Component->GetRoadLayout();
+		const FSplineCurves& Curves = Component->SplineCurves;
+		const UUnrealDriveSettings* Settings = GetDefault<UUnrealDriveSettings>();
+
+		uint32 Hash = HashValue(0, Section.SOffset);
+		Hash = HashValue(Hash, Section.SOffsetEnd_Cashed);
+		Hash = HashValue(Hash, uint8(Section.Side));
+		Hash = HashValue(Hash, uint8(NextSide));
+		Hash = HashValue(Hash, uint8(Layout.Direction));
+		Hash = HashRichCurve(Hash, Layout.ROffset);
+		Hash = HashValue(Hash, Settings->NumPointPerSegmaent);
+		Hash = HashValue(Hash, Settings->NumPointPerSection);
+		Hash = HashLODs(Hash, Settings);
+		Hash = HashValue(Hash, Component->DefaultUpVector);
+
+		// Spline points of the segments covered by the section and the reparam table over them
+		const int NumPoints = Curves.Position.Points.Num();
+		const int NumSteps = Component->ReparamStepsPerSegment;
+		if (NumPoints > 0)
+		{
+			const float Key0 = Component->GetInputKeyValueAtDistanceAlongSpline(Section.SOffset);
+			const float Key1 = Component->GetInputKeyValueAtDistanceAlongSpline(Section.SOffsetEnd_Cashed);
+			Hash = HashValue(Hash, Key0);
+			Hash = HashValue(Hash, Key1);
+
+			const int FirstPoint = FMath::Max(FMath::FloorToInt(Key0), 0);
+			const int LastPoint = FMath::CeilToInt(Key1);
+			for (int i = FirstPoint; i <= LastPoint; ++i)
+			{
+				const int PointIndex = i % NumPoints;
+				Hash = HashCurvePoint(Hash, Curves.Position.Points[PointIndex]);
+				if (Curves.Rotation.Points.IsValidIndex(PointIndex))
+				{
+					Hash = HashCurvePoint(Hash, Curves.Rotation.Points[PointIndex]);
+				}
+				if (Curves.Scale.Points.IsValidIndex(PointIndex))
+				{
+					Hash = HashCurvePoint(Hash, Curves.Scale.Points[PointIndex]);
+				}
+			}
+
+			const int LastReparamPoint = FMath::Min(LastPoint * NumSteps, Curves.ReparamTable.Points.Num() - 1);
+			for (int i = FirstPoint * NumSteps; i <= LastReparamPoint; ++i)
+			{
+				Hash = HashValue(Hash, Curves.ReparamTable.Points[i].InVal);
+				Hash = HashValue(Hash, Curves.ReparamTable.Points[i].OutVal);
+			}
+		}
+
+		if (RightSectionIndex >= 0)
+		{
+			const FRoadLaneSection& RightSection = Component->GetLaneSection(RightSectionIndex);
+			Hash = HashLanes(Hash, RightSection, RightSection.Right);
+		}
+		if (LeftSectionIndex >= 0)
+		{
+			const FRoadLaneSection& LeftSection = Component->GetLaneSection(LeftSectionIndex);
+			Hash = HashLanes(Hash, LeftSection, LeftSection.Left);
+		}
+
+		return Hash;
+	}
+}
+
 // ---------------------------------------------------------------------------------------------------------------------------------------------
 
-void FLaneProxy::InitMesh(TArray<FDynamicMeshVertex>& Vertices, TArray<uint32>& Indices)
+bool FRoadMeshData::IsUpToDate(const URoadSplineComponent* Component) const
 {
-	if (Indices.Num() > 3)
+	return SplineCurvesVersion == Component->GetSplineCurvesVersion() && LayoutVersion == Component->GetRoadLayout().GetLayoutVersion();
+}
+
+SIZE_T FRoadMeshData::GetAllocatedSize() const
+{
+	SIZE_T Size = Chunks.GetAllocatedSize();
+	for (const auto& Chunk : Chunks)
+	{
+		Size += sizeof(FRoadMeshChunk) + Chunk->GetAllocatedSize();
+	}
+	return Size;
+}
+
+SIZE_T FRoadMeshChunk::GetAllocatedSize() const
+{
+	SIZE_T Size = Vertices.GetAllocatedSize() + Lanes.GetAllocatedSize();
+	for (const FLane& Lane : Lanes)
 	{
-		IndexBuffer.Indices = Indices;
-		VertexBuffers.InitFromDynamicVertex(&VertexFactory, Vertices);
+		Size += Lane.LanePoints.GetAllocatedSize();
+		for (const TArray<uint32>& Indices : Lane.LODIndices)
+		{
+			Size += Indices.GetAllocatedSize();
+		}
+	}
+	return Size;
+}
+
+void FRoadMeshBuffers::Build(const FRoadMeshChunk& Chunk)
+{
+	check(!bIsInitialized);
+
+	NumLODs = Chunk.NumLODs;
+	FMemory::Memcpy(LODScreenSizes, Chunk.LODScreenSizes, sizeof(LODScreenSizes));
+
+	TArray<int> SortedLanes;
+	SortedLanes.Reserve(Chunk.Lanes.Num());
+	int NumIndices = 0;
+	for (int i = 0; i < Chunk.Lanes.Num(); ++i)
+	{
+		if (Chunk.Lanes[i].LODIndices[0].Num())
+		{
+			SortedLanes.Add(i);
+			for (int LODIndex = 0; LODIndex < NumLODs; ++LODIndex)
+			{
+				NumIndices += Chunk.Lanes[i].GetIndices(LODIndex).Num();
+			}
+		}
+	}
+	SortedLanes.StableSort([&Chunk](int A, int B) { return Chunk.Lanes[A].Material < Chunk.Lanes[B].Material; });
+
+	LaneRanges.SetNum(Chunk.Lanes.Num());
+	IndexBuffer.Indices.Reset(NumIndices);
+	MaterialBatches.Reset();
+	for (int LODIndex = 0; LODIndex < NumLODs; ++LODIndex)
+	{
+		for (int i : SortedLanes)
+		{
+			const FRoadMeshChunk::FLane& Lane = Chunk.Lanes[i];
+			const TArray<uint32>& Indices = Lane.GetIndices(LODIndex);
+			FLaneRange& Range = LaneRanges[i][LODIndex];
+			Range.FirstIndex = IndexBuffer.Indices.Num();
+			Range.NumPrimitives = Indices.Num() / 3;
+			Range.MinVertexIndex = Lane.MinVertexIndex;
+			Range.MaxVertexIndex = Lane.MaxVertexIndex;
+			IndexBuffer.Indices.Append(Indices);
+
+			if (MaterialBatches.Num() && MaterialBatches.Last().Material == Lane.Material && MaterialBatches.Last().LODIndex == LODIndex)
+			{
+				FMaterialBatch& Batch = MaterialBatches.Last();
+				Batch.NumPrimitives += Range.NumPrimitives;
+				Batch.MinVertexIndex = FMath::Min(Batch.MinVertexIndex, Range.MinVertexIndex);
+				Batch.MaxVertexIndex = FMath::Max(Batch.MaxVertexIndex, Range.MaxVertexIndex);
+			}
+			else
+			{
+				MaterialBatches.Add({ Lane.Material, LODIndex, Range.FirstIndex, Range.NumPrimitives, Range.MinVertexIndex, Range.MaxVertexIndex });
+			}
+		}
+	}
+
+	if (Chunk.Vertices.Num() && IndexBuffer.Indices.Num())
+	{
+		VertexBuffers.InitFromDynamicVertex(&VertexFactory, Chunk.Vertices);
 		BeginInitResource(&VertexBuffers.PositionVertexBuffer);
 		BeginInitResource(&VertexBuffers.StaticMeshVertexBuffer);
 		BeginInitResource(&VertexBuffers.ColorVertexBuffer);
 		BeginInitResource(&VertexFactory);
 		BeginInitResource(&IndexBuffer);
+		bIsInitialized = true;
 	}
 }
 
-void FLaneProxy::ReleaseResources()
+SIZE_T FRoadMeshBuffers::GetAllocatedSize() const
+{
+	return LaneRanges.GetAllocatedSize() 
+		+ MaterialBatches.GetAllocatedSize() 
+		+ IndexBuffer.Indices.GetAllocatedSize()
+		+ VertexBuffers.PositionVertexBuffer.GetAllocatedSize()
+		+ VertexBuffers.StaticMeshVertexBuffer.GetAllocatedSize()
+		+ VertexBuffers.ColorVertexBuffer.GetAllocatedSize();
+}
+
+SIZE_T FRoadMeshBuffers::GetGPUMemorySize() const
 {
-	VertexBuffers.PositionVertexBuffer.ReleaseResource();
-	VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
-	VertexBuffers.ColorVertexBuffer.ReleaseResource();
-	VertexFactory.ReleaseResource();
-	IndexBuffer.ReleaseResource();
+	if (!bIsInitialized)
+	{
+		return 0;
+	}
+
+	return IndexBuffer.Indices.Num() * sizeof(uint32)
+		+ VertexBuffers.PositionVertexBuffer.GetNumVertices() * VertexBuffers.PositionVertexBuffer.GetStride()
+		+ VertexBuffers.StaticMeshVertexBuffer.GetResourceSize()
+		+ VertexBuffers.ColorVertexBuffer.GetNumVertices() * VertexBuffers.ColorVertexBuffer.GetStride();
 }
 
-FMeshBatch * FLaneProxy::GetDynamicMeshElements(const class FPrimitiveSceneProxy& SceneProxy, const FSceneView*& View, const FSceneViewFamily& ViewFamily, FPrimitiveDrawInterface* PDI, FMeshElementCollector& Collector) const
+void FRoadMeshBuffers::ReleaseResources()
 {
-	const FMatrix& MyLocalToWorld = SceneProxy.GetLocalToWorld();
+	if (bIsInitialized)
+	{
+		VertexBuffers.PositionVertexBuffer.ReleaseResource();
+		VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+		VertexBuffers.ColorVertexBuffer.ReleaseResource();
+		VertexFactory.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		bIsInitialized = false;
+	}
+}
+
+void FRoadMeshBuffers::InitMeshBatch(const class FPrimitiveSceneProxy& SceneProxy, FMeshBatch& MeshBatch) const
+{
+	MeshBatch.VertexFactory = &VertexFactory;
+	MeshBatch.ReverseCulling = SceneProxy.IsLocalToWorldDeterminantNegative();
+	MeshBatch.Type = PT_TriangleList;
+	MeshBatch.DepthPriorityGroup = SDPG_World;//SDPG_Foreground;
+	MeshBatch.bCanApplyViewModeOverrides = false;
+	MeshBatch.Elements[0].IndexBuffer = &IndexBuffer;
+}
+
+void FRoadMeshBuffers::DrawStaticElements(const class FPrimitiveSceneProxy& SceneProxy, FStaticPrimitiveDrawInterface* PDI) const
+{
+	if (!bIsInitialized)
+	{
+		return;
+	}
 
-	if (IndexBuffer.Indices.Num() > 3)
+	for (const FMaterialBatch& Batch : MaterialBatches)
+	{
+		FMeshBatch MeshBatch;
+		InitMeshBatch(SceneProxy, MeshBatch);
+		MeshBatch.MaterialRenderProxy = Batch.Material;
+		MeshBatch.LODIndex = Batch.LODIndex;
+		MeshBatch.CastShadow = false;
+		MeshBatch.bUseForMaterial = true;
+		MeshBatch.bUseForDepthPass = true;
+		MeshBatch.bUseAsOccluder = false;
+
+		FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
+		BatchElement.FirstIndex = Batch.FirstIndex;
+		BatchElement.NumPrimitives = Batch.NumPrimitives;
+		BatchElement.MinVertexIndex = Batch.MinVertexIndex;
+		BatchElement.MaxVertexIndex = Batch.MaxVertexIndex;
+
+		PDI->DrawMesh(MeshBatch, LODScreenSizes[Batch.LODIndex]);
+	}
+}
+
+// ---------------------------------------------------------------------------------------------------------------------------------------------
+
+void FLaneProxy::InitMeshBatch(const class FPrimitiveSceneProxy& SceneProxy, FMeshBatch& MeshBatch, int LODIndex) const
+{
+	check(Buffers);
+	check(LODIndex >= 0 && LODIndex < NumLODs);
+
+	const FRoadMeshBuffers::FLaneRange& Range = Ranges[LODIndex];
+
+	Buffers->InitMeshBatch(SceneProxy, MeshBatch);
+	MeshBatch.MaterialRenderProxy = Material;
+	//MeshBatch.bWireframe = bWireframe;
+
+#if WITH_EDITOR
+	if (/*sSelected()&&*/  HitProxy.IsValid())
+	{
+		MeshBatch.BatchHitProxyId = HitProxy->Id;
+	}
+#endif
+
+	FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
+	BatchElement.FirstIndex = Range.FirstIndex;
+	BatchElement.NumPrimitives = Range.NumPrimitives;
+	BatchElement.MinVertexIndex = Range.MinVertexIndex;
+	BatchElement.MaxVertexIndex = Range.MaxVertexIndex;
+}
+
+FMeshBatch * FLaneProxy::GetDynamicMeshElements(const class FPrimitiveSceneProxy& SceneProxy, const FSceneView*& View, const FSceneViewFamily& ViewFamily, FPrimitiveDrawInterface* PDI, FMeshElementCollector& Collector, int LODIndex) const
+{
+	if (HasMesh())
 	{
 		FDynamicPrimitiveUniformBuffer& DynamicPrimitiveUniformBuffer = Collector.AllocateOneFrameResource<FDynamicPrimitiveUniformBuffer>();
 		{
@@ -238,28 +635,8 @@ FMeshBatch * FLaneProxy::GetDynamicMeshElements(const class FPrimitiveSceneProxy
 		}
 
 		FMeshBatch& MeshBatch = Collector.AllocateMesh();
-		MeshBatch.MaterialRenderProxy = Material;
-		MeshBatch.VertexFactory = &VertexFactory;
-		MeshBatch.ReverseCulling = SceneProxy.IsLocalToWorldDeterminantNegative();
-		MeshBatch.Type = PT_TriangleList;
-		MeshBatch.DepthPriorityGroup = SDPG_World;//SDPG_Foreground;
-		MeshBatch.bCanApplyViewModeOverrides = false;
-		//MeshBatch.bWireframe = bWireframe;
-
-#if WITH_EDITOR
-		if (/*sSelected()&&*/  HitProxy.IsValid())
-		{
-			MeshBatch.BatchHitProxyId = HitProxy->Id;
-		}
-#endif
-
-		FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
-		BatchElement.IndexBuffer = &IndexBuffer;
-		BatchElement.FirstIndex = 0;
-		BatchElement.NumPrimitives = IndexBuffer.Indices.Num() / 3;
-		BatchElement.MinVertexIndex = 0;
-		BatchElement.MaxVertexIndex = VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
-		BatchElement.PrimitiveUniformBufferResource = &DynamicPrimitiveUniformBuffer.UniformBuffer;
+		InitMeshBatch(SceneProxy, MeshBatch, FMath::Min(LODIndex, NumLODs - 1));
+		MeshBatch.Elements[0].PrimitiveUniformBufferResource = &DynamicPrimitiveUniformBuffer.UniformBuffer;
 
 		return &MeshBatch;
 	}
@@ -267,6 +644,26 @@ FMeshBatch * FLaneProxy::GetDynamicMeshElements(const class FPrimitiveSceneProxy
 	return nullptr;
 }
 
+void FLaneProxy::DrawStaticElements(const class FPrimitiveSceneProxy& SceneProxy, FStaticPrimitiveDrawInterface* PDI) const
+{
+	if (HasMesh())
+	{
+		// The primitive uniform buffer comes from the GPU scene, so the cached mesh draw commands stay valid until the proxy is recreated.
+		// The LOD is selected by the renderer from the screen size of the whole primitive
+		for (int LODIndex = 0; LODIndex < NumLODs; ++LODIndex)
+		{
+			FMeshBatch MeshBatch;
+			InitMeshBatch(SceneProxy, MeshBatch, LODIndex);
+			MeshBatch.LODIndex = LODIndex;
+			MeshBatch.CastShadow = false;
+			MeshBatch.bUseForMaterial = true;
+			MeshBatch.bUseForDepthPass = true;
+			MeshBatch.bUseAsOccluder = false;
+			PDI->DrawMesh(MeshBatch, Buffers->LODScreenSizes[LODIndex]);
+		}
+	}
+}
+
 void FLaneProxy::DrawLines(const FMatrix& LocalToWorld, FPrimitiveDrawInterface* PDI, bool bIsSelected) const
 {
 #if WITH_EDITOR
@@ -289,20 +686,66 @@ void FLaneProxy::DrawLines(const FMatrix& LocalToWorld, FPrimitiveDrawInterface*
 }
 
 #if WITH_EDITOR
-HRoadSplineVisProxy* FLaneProxy::CreateHitProxy(const URoadSplineComponent* Component)
+HRoadSplineVisProxy* FLaneProxy::CreateHitProxy(const URoadSplineComponent* Component, bool bIsLayoutUpToDate)
 {
-	HitProxy = new HRoadLaneVisProxy(Component, SectionIndex, LaneIndex);
+	if (SectionIndex == INDEX_NONE || !bIsLayoutUpToDate)
+	{
+		// Filled closed loop, or the section and lane indices may be invalid for the current layout
+		HitProxy = new HRoadSplineVisProxy(Component);
+	}
+	else
+	{
+		HitProxy = new HRoadLaneVisProxy(Component, SectionIndex, LaneIndex);
+	}
 	return HitProxy;	
 }
 #endif
 
-TArray<TSharedPtr<FLaneProxy>> FLaneProxy::MakeLaneProxysFromSpline(URoadSplineComponent* Component, ERHIFeatureLevel::Type FeatureLevel)
+static void UpdateChunkBounds(FRoadMeshChunk& Chunk)
+{
+	Chunk.Bounds.Init();
+	for (const FDynamicMeshVertex& Vertex : Chunk.Vertices)
+	{
+		Chunk.Bounds += FVector(Vertex.Position);
+	}
+	for (const FRoadMeshChunk::FLane& Lane : Chunk.Lanes)
+	{
+		Chunk.Bounds += FBox(Lane.LanePoints);
+	}
+}
+
+static void InitChunkLODs(FRoadMeshChunk& Chunk)
+{
+	const TArray<float>& ScreenSizes = GetDefault<UUnrealDriveSettings>()->LaneMeshLODScreenSizes;
+	Chunk.NumLODs = 1 + FMath::Min(ScreenSizes.Num(), MaxRoadMeshLODs - 1);
+	Chunk.LODScreenSizes[0] = FLT_MAX;
+	for (int LODIndex = 1; LODIndex < Chunk.NumLODs; ++LODIndex)
+	{
+		// The screen sizes must decrease with the LOD, see ComputeLODForMeshes()
+		Chunk.LODScreenSizes[LODIndex] = FMath::Min(ScreenSizes[LODIndex - 1], Chunk.LODScreenSizes[LODIndex - 1]);
+	}
+}
+
+static TSharedPtr<const FRoadMeshChunk> FindChunk(const FRoadMeshData* MeshData, int SectionIndex, uint32 Hash)
+{
+	if (MeshData)
+	{
+		for (const auto& Chunk : MeshData->Chunks)
+		{
+			if (Chunk->SectionIndex == SectionIndex && Chunk->Hash == Hash)
+			{
+				return Chunk;
+			}
+		}
+	}
+	return nullptr;
+}
+
+static void BuildLanes(const URoadSplineComponent* Component, const FRoadMeshData* Previous, FRoadMeshData& MeshData)
 {
 	const int NumPointPerSegmaent = GetDefault<UUnrealDriveSettings>()->NumPointPerSegmaent;
 	const int NumPointPerSection = GetDefault<UUnrealDriveSettings>()->NumPointPerSection;
 
-	TArray<TSharedPtr<FLaneProxy>> LanesProxy;
-
 	int PreLeftSectionIndex = -1;
 	int PreRighSectionIndex = -1;
 
@@ -323,44 +766,58 @@ TArray<TSharedPtr<FLaneProxy>> FLaneProxy::MakeLaneProxysFromSpline(URoadSplineC
 			NextSide = Component->GetLaneSection(SectionIndex + 1).Side;
 		}
 
+		const int RightSectionIndex = HasRightSide(Section.Side) ? SectionIndex : PreRighSectionIndex;
+		const int LeftSectionIndex = HasLeftSide(Section.Side) ? SectionIndex : PreLeftSectionIndex;
+		const uint32 Hash = RoadMeshChunk::HashSection(Component, SectionIndex, RightSectionIndex, LeftSectionIndex, NextSide);
+
+		if (HasRightSide(Section.Side))
+		{
+			PreRighSectionIndex = SectionIndex;
+		}
+		if (HasLeftSide(Section.Side))
+		{
+			PreLeftSectionIndex = SectionIndex;
+		}
+
+		// Reuse the unchanged section
+		if (TSharedPtr<const FRoadMeshChunk> PreviousChunk = FindChunk(Previous, SectionIndex, Hash))
+		{
+			MeshData.Chunks.Add(MoveTemp(PreviousChunk));
+			continue;
+		}
+
+		TSharedRef<FRoadMeshChunk> Chunk = MakeShared<FRoadMeshChunk>();
+		Chunk->SectionIndex = SectionIndex;
+		Chunk->Hash = Hash;
+		InitChunkLODs(*Chunk);
+
 		TArray<FSplinePositionLinearApproximation> PrevPoints;
+		TArray<double> PrevSOffsets;
 
 		// Add center lane
 		TArray<FSplinePositionLinearApproximation> CenterPoints;
-		Component->BuildLinearApproximation(CenterPoints, [&](double S) { return Component->EvalROffset(S); }, S0, S1, NumPointPerSegmaent, NumPointPerSection, ESplineCoordinateSpace::Local);
-		FLaneProxy& LaneProxy = *LanesProxy.Add_GetRef(MakeShared< FLaneProxy>(SectionIndex, 0, FeatureLevel));
-		LaneProxy.LanePoints.SetNum(CenterPoints.Num());
-		LaneProxy.LineColor = SplineColor;
-		for (int i = 0; i < CenterPoints.Num(); ++i) LaneProxy.LanePoints[i] = CenterPoints[i].Position;
+		TArray<double> CenterSOffsets;
+		Component->BuildLinearApproximation(CenterPoints, [&](double S) { return Component->EvalROffset(S); }, S0, S1, NumPointPerSegmaent, NumPointPerSection, ESplineCoordinateSpace::Local, &CenterSOffsets);
+		FRoadMeshChunk::FLane& CenterLane = Chunk->Lanes.AddDefaulted_GetRef();
+		CenterLane.SectionIndex = SectionIndex;
+		CenterLane.LanePoints.SetNum(CenterPoints.Num());
+		CenterLane.LineColor = SplineColor;
+		for (int i = 0; i < CenterPoints.Num(); ++i) CenterLane.LanePoints[i] = CenterPoints[i].Position;
+
+		// All lanes of the section are sampled at the same spline params, so the strip of each lane has 2 * CenterPoints.Num() vertices
+		const int NumSideLanes = (RightSectionIndex >= 0 ? Component->GetLaneSection(RightSectionIndex).Right.Num() : 0) + (LeftSectionIndex >= 0 ? Component->GetLaneSection(LeftSectionIndex).Left.Num() : 0);
+		Chunk->Vertices.Reserve(2 * CenterPoints.Num() * NumSideLanes);
 
 
 		// Add right lanes
 		PrevPoints = CenterPoints;
-		if (HasRightSide(Section.Side))
-		{
-			for (int i = 0; i < Section.Right.Num(); ++i)
-			{
-				auto& Lane = Section.Right[i];
-				if (auto NewProxy = MakeLaneProxy(PrevPoints, Component, SectionIndex, +i + 1, S0, S1, true, HasRightSide(NextSide), FeatureLevel))
-				{
-					LanesProxy.Add(MoveTemp(NewProxy));
-				}
-				else
-				{
-					break;
-				}
-			}
-			PreRighSectionIndex = SectionIndex;
-		}
-		else if (PreRighSectionIndex >= 0)
+		PrevSOffsets = CenterSOffsets;
+		if (RightSectionIndex >= 0)
 		{
-			for (int i = 0; i < Component->GetLaneSection(PreRighSectionIndex).Right.Num(); ++i)
+			const bool bDrawStartCap = RightSectionIndex == SectionIndex;
+			for (int i = 0; i < Component->GetLaneSection(RightSectionIndex).Right.Num(); ++i)
 			{
-				if (auto NewProxy = MakeLaneProxy(PrevPoints, Component, PreRighSectionIndex, +i + 1, S0, S1, false, HasRightSide(NextSide), FeatureLevel))
-				{
-					LanesProxy.Add(MoveTemp(NewProxy));
-				}
-				else
+				if (!MakeLane(PrevPoints, PrevSOffsets, Component, RightSectionIndex, +i + 1, S0, S1, bDrawStartCap, HasRightSide(NextSide), *Chunk))
 				{
 					break;
 				}
@@ -369,75 +826,63 @@ TArray<TSharedPtr<FLaneProxy>> FLaneProxy::MakeLaneProxysFromSpline(URoadSplineC
 
 		// Add left lanes
 		PrevPoints = CenterPoints;
-		if (HasLeftSide(Section.Side))
+		PrevSOffsets = CenterSOffsets;
+		if (LeftSectionIndex >= 0)
 		{
-			for (int i = 0; i < Section.Left.Num(); ++i)
+			const bool bDrawStartCap = LeftSectionIndex == SectionIndex;
+			for (int i = 0; i < Component->GetLaneSection(LeftSectionIndex).Left.Num(); ++i)
 			{
-				auto& Lane = Section.Left[i];
-				if (auto NewProxy = MakeLaneProxy(PrevPoints, Component, SectionIndex, -i - 1, S0, S1, true, HasLeftSide(NextSide), FeatureLevel))
-				{
-					LanesProxy.Add(MoveTemp(NewProxy));
-				}
-				else
+				if (!MakeLane(PrevPoints, PrevSOffsets, Component, LeftSectionIndex, -i - 1, S0, S1, bDrawStartCap, HasLeftSide(NextSide), *Chunk))
 				{
 					break;
 				}
 			}
-			PreLeftSectionIndex = SectionIndex;
 		}
-		else if (PreLeftSectionIndex >= 0)
-		{
-			for (int i = 0; i < Component->GetLaneSection(PreLeftSectionIndex).Left.Num(); ++i)
-			{
-				if (auto NewProxy = MakeLaneProxy(PrevPoints, Component, PreLeftSectionIndex, -i - 1, S0, S1, false, HasLeftSide(NextSide), FeatureLevel))
-				{
-					LanesProxy.Add(MoveTemp(NewProxy));
-				}
-				else
-				{
-					break;
-				}
-			}
-		}
-	}
 
-	return LanesProxy;
+		RoadMeshLOD::BuildChunkLODs(*Chunk, CenterPoints.Num());
+
+		UpdateChunkBounds(*Chunk);
+		MeshData.Chunks.Add(MoveTemp(Chunk));
+	}
 }
 
-TSharedPtr<FLaneProxy> FLaneProxy::MakeLoopProxyFromSpline(URoadSplineComponent* Component, ERHIFeatureLevel::Type FeatureLevel)
+static void BuildLoop(const URoadSplineComponent* Component, const FRoadMeshData* Previous, FRoadMeshData& MeshData)
 {
+	UMaterialInstance* Material = UUnrealDriveSettings::GetLaneMatrtial(Component->GetRoadLayout().FilledInstance);
+	check(Material);
 
-	struct FLaneProxyLoop : public FLaneProxy
+	// The loop outline depends on the whole spline
+	uint32 Hash = RoadMeshChunk::HashValue(0, Material);
+	Hash = RoadMeshChunk::HashLODs(Hash, GetDefault<UUnrealDriveSettings>());
+	for (const auto& Point : Component->SplineCurves.Position.Points)
 	{
-		FLaneProxyLoop(ERHIFeatureLevel::Type FeatureLevel)
-			: FLaneProxy(INDEX_NONE, 0, FeatureLevel)
-		{
-		}
-#if WITH_EDITOR
-		virtual HRoadSplineVisProxy* CreateHitProxy(const URoadSplineComponent* Component) override
-		{
-			HitProxy = new HRoadSplineVisProxy(Component);
-			return HitProxy;
-		}
-#endif
-	};
+		Hash = RoadMeshChunk::HashCurvePoint(Hash, Point);
+	}
 
-	auto LaneProxy = MakeShared< FLaneProxyLoop>(FeatureLevel);
+	if (TSharedPtr<const FRoadMeshChunk> PreviousChunk = FindChunk(Previous, INDEX_NONE, Hash))
+	{
+		MeshData.Chunks.Add(MoveTemp(PreviousChunk));
+		return;
+	}
 
-	UMaterialInstance* Material = UUnrealDriveSettings::GetLaneMatrtial(Component->GetRoadLayout().FilledInstance);
-	check(Material);
-	LaneProxy->Material = Material->GetRenderProxy();
-	LaneProxy->LineColor = SplineColor;
-	ConvertSplineToPolyLine(Component, LaneProxy->LanePoints);
+	// The loop has only the full mesh, it's drawn by each LOD of the buffers (see FRoadMeshChunk::FLane::GetIndices())
+	TSharedRef<FRoadMeshChunk> Chunk = MakeShared<FRoadMeshChunk>();
+	Chunk->Hash = Hash;
+	InitChunkLODs(*Chunk);
+
+	FRoadMeshChunk::FLane& LoopLane = Chunk->Lanes.AddDefaulted_GetRef();
+	LoopLane.Material = Material->GetRenderProxy();
+	LoopLane.LineColor = SplineColor;
+	ConvertSplineToPolyLine(Component, LoopLane.LanePoints);
 
 	TArray<FDynamicMeshVertex> Verts;
-	Verts.Reserve(LaneProxy->LanePoints.Num());
-	for (int i = 0; i < LaneProxy->LanePoints.Num(); ++i)
+	Verts.Reserve(LoopLane.LanePoints.Num());
+	for (int i = 0; i < LoopLane.LanePoints.Num(); ++i)
 	{
-		Verts.Emplace(FVector3f(LaneProxy->LanePoints[i]), FVector2f{ 0.0, 0.0 }, FColor::Black);
+		Verts.Emplace(FVector3f(LoopLane.LanePoints[i]), FVector2f{ 0.0, 0.0 }, FColor::Black);
 	}
 
-	FPolygon2d Polygon(LaneProxy->LanePoints);
+	FPolygon2d Polygon(LoopLane.LanePoints);
 	FConstrainedDelaunay2d Triangulation;
 	Triangulation.FillRule = Polygon.IsClockwise() ? FConstrainedDelaunay2d::EFillRule::Negative : FConstrainedDelaunay2d::EFillRule::Positive;
 	Triangulation.Add(Polygon);
@@ -452,6 +897,77 @@ TSharedPtr<FLaneProxy> FLaneProxy::MakeLoopProxyFromSpline(URoadSplineComponent*
 		}
 	}
 
-	LaneProxy->InitMesh(Verts, Indices);
-	return MoveTemp(LaneProxy);
-}
\ No newline at end of file
+	AppendLaneMesh(*Chunk, LoopLane, Verts, MakeArrayView(&Indices, 1));
+	UpdateChunkBounds(*Chunk);
+	MeshData.Chunks.Add(MoveTemp(Chunk));
+}
+
+TSharedRef<FRoadMeshData> FRoadMeshData::Build(const URoadSplineComponent* Component, const FRoadMeshData* Previous)
+{
+	TSharedRef<FRoadMeshData> MeshData = MakeShared<FRoadMeshData>();
+	MeshData->SplineCurvesVersion = Component->GetSplineCurvesVersion();
+	MeshData->LayoutVersion = Component->GetRoadLayout().GetLayoutVersion();
+
+	BuildLanes(Component, Previous, *MeshData);
+
+	if (Component->IsClosedLoop() && Component->GetRoadLayout().FilledInstance.IsValid())
+	{
+		BuildLoop(Component, Previous, *MeshData);
+	}
+
+	return MeshData;
+}
+
+TSharedRef<FRoadMeshBuffers> FRoadMeshChunk::GetBuffers(ERHIFeatureLevel::Type FeatureLevel) const
+{
+	FScopeLock Lock(&BuffersLock);
+	if (!Buffers.IsValid() || Buffers->FeatureLevel != FeatureLevel)
+	{
+		// The chunk may be released on the game thread, the render resources must be released on the render thread
+		Buffers = TSharedPtr<FRoadMeshBuffers>(new FRoadMeshBuffers(FeatureLevel), [](FRoadMeshBuffers* InBuffers)
+		{
+			ENQUEUE_RENDER_COMMAND(ReleaseRoadMeshBuffers)([InBuffers](FRHICommandListImmediate& RHICmdList)
+			{
+				delete InBuffers;
+			});
+		});
+		Buffers->Build(*this);
+	}
+	return Buffers.ToSharedRef();
+}
+
+TArray<TSharedPtr<FLaneProxy>> FLaneProxy::MakeLaneProxies(const FRoadMeshData& MeshData, ERHIFeatureLevel::Type FeatureLevel, TArray<TSharedPtr<FRoadMeshBuffers>>& OutBuffers)
+{
+	int NumLanes = 0;
+	for (const auto& Chunk : MeshData.Chunks)
+	{
+		NumLanes += Chunk->Lanes.Num();
+	}
+
+	TArray<TSharedPtr<FLaneProxy>> LanesProxy;
+	LanesProxy.Reserve(NumLanes);
+	OutBuffers.Reset(MeshData.Chunks.Num());
+
+	for (int ChunkIndex = 0; ChunkIndex < MeshData.Chunks.Num(); ++ChunkIndex)
+	{
+		const FRoadMeshChunk* Chunk = MeshData.Chunks[ChunkIndex].Get();
+		const TSharedRef<FRoadMeshBuffers> Buffers = Chunk->GetBuffers(FeatureLevel);
+		for (int i = 0; i < Chunk->Lanes.Num(); ++i)
+		{
+			FLaneProxy& LaneProxy = *LanesProxy.Add_GetRef(MakeShared<FLaneProxy>(Chunk->Lanes[i]));
+			LaneProxy.ChunkIndex = ChunkIndex;
+			if (Buffers->bIsInitialized && Chunk->Lanes[i].LODIndices[0].Num())
+			{
+				LaneProxy.Buffers = &Buffers.Get();
+				LaneProxy.NumLODs = Buffers->NumLODs;
+				for (int LODIndex = 0; LODIndex < Buffers->NumLODs; ++LODIndex)
+				{
+					LaneProxy.Ranges[LODIndex] = Buffers->LaneRanges[i][LODIndex];
+				}
+			}
+		}
+		OutBuffers.Add(Buffers);
+	}
+
+	return LanesProxy;
+}
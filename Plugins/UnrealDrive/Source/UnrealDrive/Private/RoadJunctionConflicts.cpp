@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "RoadJunctionConflicts.h"
+#include "RoadLaneGraph.h"
+#include "RoadSplineComponent.h"
+#include "BoxBVH.h"
+
+namespace RoadJunctionConflicts
+{
+	// Lanes which are closer than the sum of their half widths minus this value are in conflict [cm]. Excludes the side by side lanes
+	static constexpr double Clearance = 10.0;
+
+	// Max distance between the lane ends to treat the conflict as merging / diverging [cm]
+	static constexpr double EndpointTolerance = 50.0;
+
+	struct FLaneSample
+	{
+		FVector Location;
+		double S;
+		double HalfWidth;
+	};
+
+	struct FJunctionLane
+	{
+		int Node;
+		TArray<FLaneSample> Samples;
+		double MaxHalfWidth = 0;
+	};
+
+	static void SampleLane(const FRoadLaneGraph::FNode& Node, double SampleStep, FJunctionLane& OutLane)
+	{
+		const int NumSegments = FMath::Max(1, FMath::CeilToInt((Node.SOffset1 - Node.SOffset0) / SampleStep));
+
+		TArray<FRoadLanePositionQuery> Queries;
+		Queries.Reserve((NumSegments + 1) * 2);
+		for (int i = 0; i <= NumSegments; ++i)
+		{
+			const double S = FMath::Lerp(Node.SOffset0, Node.SOffset1, double(i) / NumSegments);
+			Queries.Add({ Node.SectionIndex, Node.LaneIndex, 0.0, S });
+			Queries.Add({ Node.SectionIndex, Node.LaneIndex, 1.0, S });
+		}
+
+		TArray<FRoadPosition> Positions;
+		Positions.SetNumUninitialized(Queries.Num());
+		Node.RoadSpline->GetRoadPositions(Queries, Positions, ESplineCoordinateSpace::World);
+
+		OutLane.Samples.SetNumUninitialized(NumSegments + 1);
+		for (int i = 0; i <= NumSegments; ++i)
+		{
+			const FVector& Inner = Positions[i * 2].Location;
+			const FVector& Outer = Positions[i * 2 + 1].Location;
+			FLaneSample& Sample = OutLane.Samples[i];
+			Sample.Location = (Inner + Outer) * 0.5;
+			Sample.S = Queries[i * 2].SOffset;
+			Sample.HalfWidth = FVector::Dist(Inner, Outer) * 0.5;
+			OutLane.MaxHalfWidth = FMath::Max(OutLane.MaxHalfWidth, Sample.HalfWidth);
+		}
+	}
+
+	/** @return true if the lanes overlap, the S ranges cover all overlapped segments of the lanes */
+	static bool FindOverlap(const FJunctionLane& A, const FJunctionLane& B, FRoadLaneConflict& OutConflict)
+	{
+		double S0 = TNumericLimits<double>::Max();
+		double S1 = TNumericLimits<double>::Lowest();
+		double OtherS0 = S0;
+		double OtherS1 = S1;
+
+		for (int i = 0; i + 1 < A.Samples.Num(); ++i)
+		{
+			const FLaneSample& A0 = A.Samples[i];
+			const FLaneSample& A1 = A.Samples[i + 1];
+			const double HalfWidthA = FMath::Max(A0.HalfWidth, A1.HalfWidth);
+
+			for (int j = 0; j + 1 < B.Samples.Num(); ++j)
+			{
+				const FLaneSample& B0 = B.Samples[j];
+				const FLaneSample& B1 = B.Samples[j + 1];
+				const double Threshold = HalfWidthA + FMath::Max(B0.HalfWidth, B1.HalfWidth) - Clearance;
+				if (Threshold <= 0)
+				{
+					continue;
+				}
+
+				FVector PointA, PointB;
+				FMath::SegmentDistToSegmentSafe(A0.Location, A1.Location, B0.Location, B1.Location, PointA, PointB);
+				if (FVector::DistSquared(PointA, PointB) < FMath::Square(Threshold))
+				{
+					S0 = FMath::Min(S0, A0.S);
+					S1 = FMath::Max(S1, A1.S);
+					OtherS0 = FMath::Min(OtherS0, B0.S);
+					OtherS1 = FMath::Max(OtherS1, B1.S);
+				}
+			}
+		}
+
+		if (S0 > S1)
+		{
+			return false;
+		}
+
+		OutConflict.S0 = S0;
+		OutConflict.S1 = S1;
+		OutConflict.OtherS0 = OtherS0;
+		OutConflict.OtherS1 = OtherS1;
+		return true;
+	}
+
+	/** @return true if one lane continues the other, such lanes touch at the shared end and aren't in conflict */
+	static bool AreLinked(const FRoadLaneGraph& LaneGraph, int NodeA, int NodeB)
+	{
+		return LaneGraph.GetSuccessors(NodeA).Contains(NodeB) || LaneGraph.GetSuccessors(NodeB).Contains(NodeA);
+	}
+
+	/** @return number of the different roads attached to the lane connections of the section end the LaneConnection belongs to */
+	static int CountAttachedRoads(const ULaneConnection* LaneConnection)
+	{
+		const URoadSplineComponent* RoadSpline = LaneConnection->GetOwnedRoadSpline();
+		if (!RoadSpline || !RoadSpline->GetRoadLayout().Sections.IsValidIndex(LaneConnection->GetSectionIndex()))
+		{
+			return 0;
+		}
+
+		const FRoadLaneSection& Section = RoadSpline->GetRoadLayout().Sections[LaneConnection->GetSectionIndex()];
+		const bool bIsSuccessor = LaneConnection->IsSuccessorConnection();
+
+		TArray<const URoadSplineComponent*, TInlineAllocator<8>> AttachedRoads;
+		auto AddAttachedRoads = [&](const FRoadLane& Lane)
+		{
+			if (const ULaneConnection* Connection = bIsSuccessor ? Lane.SuccessorConnection : Lane.PredecessorConnection)
+			{
+				for (const TWeakObjectPtr<URoadConnection>& RoadConnection : Connection->OuterRoadConnections)
+				{
+					if (const URoadSplineComponent* AttachedRoad = RoadConnection.IsValid() ? RoadConnection->GetOwnedRoadSpline() : nullptr)
+					{
+						AttachedRoads.AddUnique(AttachedRoad);
+					}
+				}
+			}
+		};
+
+		for (const FRoadLane& Lane : Section.Left)
+		{
+			AddAttachedRoads(Lane);
+		}
+		for (const FRoadLane& Lane : Section.Right)
+		{
+			AddAttachedRoads(Lane);
+		}
+		return AttachedRoads.Num();
+	}
+}
+
+bool FRoadJunctionConflicts::IsJunctionRoad(const URoadSplineComponent* RoadSpline)
+{
+	using namespace RoadJunctionConflicts;
+
+	const URoadConnection* Predecessor = RoadSpline->GetPredecessorConnection();
+	const URoadConnection* Successor = RoadSpline->GetSuccessorConnection();
+	if (!Predecessor || !Successor || !Predecessor->IsConnected() || !Successor->IsConnected())
+	{
+		return false;
+	}
+
+	const ULaneConnection* PredecessorLane = Predecessor->GetOuterConnection();
+	const ULaneConnection* SuccessorLane = Successor->GetOuterConnection();
+	const URoadSplineComponent* PredecessorRoad = PredecessorLane ? PredecessorLane->GetOwnedRoadSpline() : nullptr;
+	const URoadSplineComponent* SuccessorRoad = SuccessorLane ? SuccessorLane->GetOwnedRoadSpline() : nullptr;
+	if (!PredecessorRoad || !SuccessorRoad || PredecessorRoad == SuccessorRoad)
+	{
+		return false;
+	}
+
+	// A road of a plain chain is the only road attached to the ends of its neighbours, the junction roads branch from them
+	return CountAttachedRoads(PredecessorLane) > 1 || CountAttachedRoads(SuccessorLane) > 1;
+}
+
+void FRoadJunctionConflicts::Reset()
+{
+	Offsets.Empty();
+	Conflicts.Empty();
+}
+
+const FRoadLaneConflict* FRoadJunctionConflicts::FindConflict(int NodeIndex, int OtherNodeIndex) const
+{
+	for (const FRoadLaneConflict& Conflict : GetConflicts(NodeIndex))
+	{
+		if (Conflict.OtherNode == OtherNodeIndex)
+		{
+			return &Conflict;
+		}
+	}
+	return nullptr;
+}
+
+void FRoadJunctionConflicts::Build(const FRoadLaneGraph& LaneGraph, double SampleStep)
+{
+	using namespace RoadJunctionConflicts;
+
+	check(SampleStep > 0);
+
+	Reset();
+
+	// Sample the junction lanes
+	TArray<FJunctionLane> Lanes;
+	TMap<const URoadSplineComponent*, bool> JunctionRoads;
+	for (int NodeIndex = 0; NodeIndex < LaneGraph.NumNodes(); ++NodeIndex)
+	{
+		const FRoadLaneGraph::FNode& Node = LaneGraph.GetNode(NodeIndex);
+		bool* bIsJunction = JunctionRoads.Find(Node.RoadSpline);
+		if (!bIsJunction)
+		{
+			bIsJunction = &JunctionRoads.Add(Node.RoadSpline, IsJunctionRoad(Node.RoadSpline));
+		}
+		if (*bIsJunction && Node.GetLength() > UE_KINDA_SMALL_NUMBER)
+		{
+			FJunctionLane& Lane = Lanes.AddDefaulted_GetRef();
+			Lane.Node = NodeIndex;
+			SampleLane(Node, SampleStep, Lane);
+		}
+	}
+
+	TArray<FBox> LaneBounds;
+	LaneBounds.Reserve(Lanes.Num());
+	for (const FJunctionLane& Lane : Lanes)
+	{
+		FBox Bounds(ForceInit);
+		for (const FLaneSample& Sample : Lane.Samples)
+		{
+			Bounds += Sample.Location;
+		}
+		LaneBounds.Add(Bounds.ExpandBy(Lane.MaxHalfWidth));
+	}
+
+	UnrealDrive::FBoxBVH LanesBVH;
+	LanesBVH.Build(LaneBounds);
+
+	// Find the overlapped pairs, each pair is stored for both lanes
+	TArray<TArray<FRoadLaneConflict>> NodeConflicts;
+	NodeConflicts.SetNum(LaneGraph.NumNodes());
+
+	for (int i = 0; i < Lanes.Num(); ++i)
+	{
+		const FJunctionLane& A = Lanes[i];
+		const FRoadLaneGraph::FNode& NodeA = LaneGraph.GetNode(A.Node);
+
+		LanesBVH.Query(LaneBounds[i], [&](int j)
+		{
+			if (j <= i)
+			{
+				return true;
+			}
+
+			const FJunctionLane& B = Lanes[j];
+			const FRoadLaneGraph::FNode& NodeB = LaneGraph.GetNode(B.Node);
+			if (NodeA.RoadSpline == NodeB.RoadSpline || AreLinked(LaneGraph, A.Node, B.Node))
+			{
+				return true;
+			}
+
+			FRoadLaneConflict Conflict;
+			if (!FindOverlap(A, B, Conflict))
+			{
+				return true;
+			}
+
+			if (FVector::Dist(NodeA.TravelEndLocation, NodeB.TravelEndLocation) < EndpointTolerance)
+			{
+				Conflict.Type = ERoadLaneConflictType::Merging;
+			}
+			else if (FVector::Dist(NodeA.TravelStartLocation, NodeB.TravelStartLocation) < EndpointTolerance)
+			{
+				Conflict.Type = ERoadLaneConflictType::Diverging;
+			}
+
+			Conflict.OtherNode = B.Node;
+			NodeConflicts[A.Node].Add(Conflict);
+
+			Swap(Conflict.S0, Conflict.OtherS0);
+			Swap(Conflict.S1, Conflict.OtherS1);
+			Conflict.OtherNode = A.Node;
+			NodeConflicts[B.Node].Add(Conflict);
+			return true;
+		});
+	}
+
+	Offsets.SetNumUninitialized(LaneGraph.NumNodes() + 1);
+	for (int NodeIndex = 0; NodeIndex < NodeConflicts.Num(); ++NodeIndex)
+	{
+		Offsets[NodeIndex] = Conflicts.Num();
+		NodeConflicts[NodeIndex].Sort([](const FRoadLaneConflict& A, const FRoadLaneConflict& B) { return A.S0 < B.S0; });
+		Conflicts.Append(NodeConflicts[NodeIndex]);
+	}
+	Offsets[LaneGraph.NumNodes()] = Conflicts.Num();
+}
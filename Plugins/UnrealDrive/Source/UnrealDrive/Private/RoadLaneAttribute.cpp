@@ -8,6 +8,7 @@
 #include "Animation/AttributeTypes.h"
 #include "Animation/IAttributeBlendOperator.h"
 #include "Templates/Casts.h"
+#include "Algo/BinarySearch.h"
 
 //#include UE_INLINE_GENERATED_CPP_BY_NAME(AttributeCurve)
 
@@ -124,15 +125,8 @@ void FRoadLaneAttribute::EvaluateToPtr(const UScriptStruct* InScriptStruct, doub
 			}
 			else if (SOffset < Keys[Keys.Num() - 1].SOffset)
 			{
-				// The key is in the range of Key[0] to Keys[Keys.Num()-1].  Find it by searching
-				for (int32 i = 0; i < Keys.Num(); ++i)
-				{
-					if (SOffset < Keys[i].SOffset)
-					{
-						DataPtr = Keys[FMath::Max(0, i - 1)].Value.GetPtr<FRoadLaneAttributeValue>();
-						break;
-					}
-				}
+				// The key is in the range of Key[0] to Keys[Keys.Num()-1].  Find it by binary searching
+				DataPtr = Keys[FMath::Max(0, FindKeyBeforeOrAt(SOffset))].Value.GetPtr<FRoadLaneAttributeValue>();
 			}
 			else
 			{
@@ -157,8 +151,7 @@ TArray<FRoadLaneAttributeKey>::TConstIterator FRoadLaneAttribute::GetKeyIterator
 
 int FRoadLaneAttribute::AddKey(double InSOffset, const void* InStructMemory)
 {
-	int32 Index = 0;
-	for (; Index < Keys.Num() && Keys[Index].SOffset < InSOffset; ++Index);
+	const int32 Index = Algo::LowerBoundBy(Keys, InSOffset, &FRoadLaneAttributeKey::SOffset);
 
 	FRoadLaneAttributeKey& NewKey = Keys.Insert_GetRef(FRoadLaneAttributeKey(InSOffset), Index);
 	NewKey.Value.InitializeAsScriptStruct(ScriptStruct, (uint8*)InStructMemory);
@@ -169,22 +162,11 @@ int FRoadLaneAttribute::AddKey(double InSOffset, const void* InStructMemory)
 
 int FRoadLaneAttribute::UpdateOrAddKey(double InSOffset, const void* InStructMemory, double KeySOffsetTolerance)
 {
-	for (int32 KeyIndex = 0; KeyIndex < Keys.Num(); ++KeyIndex)
+	const int32 KeyIndex = FindKey(InSOffset, KeySOffsetTolerance);
+	if (KeyIndex != INDEX_NONE)
 	{
-		double KeySOffset = Keys[KeyIndex].SOffset;
-
-		if (FMath::IsNearlyEqual(KeySOffset, InSOffset, KeySOffsetTolerance))
-		{
-			Keys[KeyIndex].Value.InitializeAsScriptStruct(ScriptStruct, (uint8*)InStructMemory);
-			return KeyIndex;
-		}
-
-		if (KeySOffset > InSOffset)
-		{
-			// All the rest of the keys exist after the key we want to add
-			// so there is no point in searching
-			break;
-		}
+		Keys[KeyIndex].Value.InitializeAsScriptStruct(ScriptStruct, (uint8*)InStructMemory);
+		return KeyIndex;
 	}
 
 	// A key wasnt found, add it now
@@ -261,6 +243,41 @@ int FRoadLaneAttribute::FindKeyBeforeOrAt(double KeySOffset) const
 	return FoundIndex;
 }
 
+bool FRoadLaneAttribute::FindKeysInRange(double S0, double S1, int& OutStartKey, int& OutEndKey) const
+{
+	OutStartKey = INDEX_NONE;
+	OutEndKey = INDEX_NONE;
+
+	if (Keys.Num() == 0 || S1 < Keys[0].SOffset)
+	{
+		return false;
+	}
+
+	// Last key at or before S0 is the key active at S0
+	OutStartKey = FMath::Max(0, Algo::UpperBoundBy(Keys, S0, &FRoadLaneAttributeKey::SOffset) - 1);
+
+	// Last key strictly before S1, keys placed exactly at S1 have zero length spans inside the interval
+	OutEndKey = FMath::Max(OutStartKey, Algo::LowerBoundBy(Keys, S1, &FRoadLaneAttributeKey::SOffset) - 1);
+
+	return true;
+}
+
+void FRoadLaneAttribute::ForEachSpanInRange(double S0, double S1, TFunctionRef<void(int KeyIndex, double SpanS0, double SpanS1)> Visitor) const
+{
+	int StartKey, EndKey;
+	if (!FindKeysInRange(S0, S1, StartKey, EndKey))
+	{
+		return;
+	}
+
+	for (int KeyIndex = StartKey; KeyIndex <= EndKey; ++KeyIndex)
+	{
+		const double SpanS0 = FMath::Max(S0, Keys[KeyIndex].SOffset);
+		const double SpanS1 = (KeyIndex < EndKey) ? Keys[KeyIndex + 1].SOffset : S1;
+		Visitor(KeyIndex, SpanS0, SpanS1);
+	}
+}
+
 void FRoadLaneAttribute::RemoveRedundantKeys()
 {
 	TSet<int32> KeyIndicesToRemove;
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "RoadLaneCursor.h"
+#include "RoadLaneGraph.h"
+#include "DefaultRoadLaneAttributes.h"
+
+FRoadLaneCursor::FRoadLaneCursor(const URoadSplineComponent* InRoadSpline, int InSectionIndex, int InLaneIndex, double InSOffset, double InAlpha)
+{
+	SetLane(InRoadSpline, InSectionIndex, InLaneIndex, InSOffset, InAlpha);
+}
+
+void FRoadLaneCursor::Reset()
+{
+	*this = FRoadLaneCursor{};
+}
+
+bool FRoadLaneCursor::SetLane(const URoadSplineComponent* InRoadSpline, int InSectionIndex, int InLaneIndex, double InSOffset, double InAlpha)
+{
+	Reset();
+
+	if (!InRoadSpline || InLaneIndex == LANE_INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FRoadLayout& Layout = InRoadSpline->GetRoadLayout();
+	if (!Layout.Sections.IsValidIndex(InSectionIndex))
+	{
+		return false;
+	}
+
+	const int SideSectionIndex = Layout.FindSideSection(InSectionIndex, InLaneIndex > 0 ? ERoadLaneSectionSide::Right : ERoadLaneSectionSide::Left);
+	if (SideSectionIndex < 0 || !Layout.Sections[SideSectionIndex].CheckLaneIndex(InLaneIndex))
+	{
+		return false;
+	}
+
+	Alpha = InAlpha;
+	SetLaneInner(InRoadSpline, Layout.Sections[SideSectionIndex].GetLaneByIndex(InLaneIndex).GetStartSectionIndex(), InLaneIndex, InSOffset);
+	return true;
+}
+
+void FRoadLaneCursor::SetLaneInner(const URoadSplineComponent* InRoadSpline, int InSectionIndex, int InLaneIndex, double InSOffset)
+{
+	const bool bIsSameSpline = RoadSpline == InRoadSpline;
+
+	RoadSpline = InRoadSpline;
+	SectionIndex = InSectionIndex;
+	LaneIndex = InLaneIndex;
+	Lane = &RoadSpline->GetLaneSection(SectionIndex).GetLaneByIndex(LaneIndex);
+	bIsForward = Lane->IsForwardLane();
+	LaneSOffset0 = Lane->GetStartOffset();
+	LaneSOffset1 = FMath::Max(Lane->GetEndOffset(), LaneSOffset0);
+	SOffset = FMath::Clamp(InSOffset, LaneSOffset0, LaneSOffset1);
+
+	// The reparam and the ROffset hints stay valid on the same spline
+	if (!bIsSameSpline)
+	{
+		ReparamHint = 0;
+		ROffsetSpanHint = 0;
+	}
+	WidthSpanHints.Init(0, FMath::Abs(LaneIndex));
+	AttributeHints.Reset();
+}
+
+double FRoadLaneCursor::Advance(double Distance, const FRoadLaneGraph* LaneGraph, const FRoadLaneRoute* Route)
+{
+	check(Distance >= 0);
+
+	if (!IsValid())
+	{
+		return Distance;
+	}
+
+	// Protects from the infinite loop on the zero length lanes
+	static constexpr int MaxLaneSwitches = 64;
+
+	double Remaining = Distance;
+	for (int NumSwitches = 0; NumSwitches <= MaxLaneSwitches; ++NumSwitches)
+	{
+		const double DistanceToEnd = GetDistanceToLaneEnd();
+		if (Remaining <= DistanceToEnd)
+		{
+			SOffset += bIsForward ? Remaining : -Remaining;
+			return 0.0;
+		}
+
+		Remaining -= DistanceToEnd;
+		SOffset = bIsForward ? LaneSOffset1 : LaneSOffset0;
+
+		if (!LaneGraph || !SwitchToSuccessor(*LaneGraph, Route))
+		{
+			break;
+		}
+	}
+	return Remaining;
+}
+
+bool FRoadLaneCursor::SwitchToSuccessor(const FRoadLaneGraph& LaneGraph, const FRoadLaneRoute* Route)
+{
+	const int Node = LaneGraph.FindNode(RoadSpline, SectionIndex, LaneIndex);
+	if (Node == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const TConstArrayView<int> Successors = LaneGraph.GetSuccessors(Node);
+	int NextNode = INDEX_NONE;
+
+	if (Route)
+	{
+		if (!Route->Nodes.IsValidIndex(RouteIndex) || Route->Nodes[RouteIndex] != Node)
+		{
+			RouteIndex = Route->Nodes.Find(Node);
+		}
+		if (RouteIndex != INDEX_NONE && RouteIndex + 1 < Route->Nodes.Num() && Successors.Contains(Route->Nodes[RouteIndex + 1]))
+		{
+			NextNode = Route->Nodes[++RouteIndex];
+		}
+	}
+	else if (Successors.Num())
+	{
+		NextNode = Successors[0];
+	}
+
+	if (NextNode == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FRoadLaneGraph::FNode& Next = LaneGraph.GetNode(NextNode);
+	SetLaneInner(Next.RoadSpline, Next.SectionIndex, Next.LaneIndex, Next.bIsForward ? Next.SOffset0 : Next.SOffset1);
+	return true;
+}
+
+double FRoadLaneCursor::GetLaneWidth() const
+{
+	check(IsValid());
+	const double LocalS = SOffset - LaneSOffset0;
+	return Lane->EvalWidth(LocalS, WidthSpanHints.Last());
+}
+
+double FRoadLaneCursor::GetROffset() const
+{
+	check(IsValid());
+
+	// The same as FRoadLaneSection::EvalLaneROffset(), but with the search hints
+	const FRoadLaneSection& Section = RoadSpline->GetLaneSection(SectionIndex);
+	const TArray<FRoadLane>& Lanes = LaneIndex > 0 ? Section.Right : Section.Left;
+	const double LocalS = SOffset - Section.SOffset;
+	const int NumLanes = FMath::Abs(LaneIndex);
+
+	double InnerBorder = 0;
+	for (int i = 0; i < NumLanes - 1; ++i)
+	{
+		InnerBorder += Lanes[i].EvalWidth(LocalS, WidthSpanHints[i]);
+	}
+	const double OuterBorder = InnerBorder + Lanes[NumLanes - 1].EvalWidth(LocalS, WidthSpanHints[NumLanes - 1]);
+
+	return FMath::Lerp(InnerBorder, OuterBorder, Alpha) * (LaneIndex > 0 ? 1 : -1) + RoadSpline->GetRoadLayout().EvalROffset(SOffset, ROffsetSpanHint);
+}
+
+FRoadPosition FRoadLaneCursor::GetRoadPosition(ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	check(IsValid());
+
+	const float Param = UnrealDrive::EvalReparamTable(RoadSpline->SplineCurves.ReparamTable, SOffset, ReparamHint);
+	const FQuat Quat = RoadSpline->GetQuaternionAtSplineInputKey(Param, CoordinateSpace);
+
+	FRoadPosition Pos;
+	Pos.ROffset = GetROffset();
+	Pos.SOffset = SOffset;
+	Pos.Location = RoadSpline->GetLocationAtSplineInputKey(Param, CoordinateSpace) + Quat.GetRightVector() * Pos.ROffset;
+	Pos.Quat = Quat;
+	return Pos;
+}
+
+int FRoadLaneCursor::FindAttributeKey(FName AttributeName, const FRoadLaneAttribute*& OutAttribute) const
+{
+	check(IsValid());
+
+	FAttributeHint* Hint = AttributeHints.FindByPredicate([AttributeName](const FAttributeHint& It) { return It.Name == AttributeName; });
+	if (!Hint)
+	{
+		Hint = &AttributeHints.AddDefaulted_GetRef();
+		Hint->Name = AttributeName;
+		Hint->Attribute = Lane->Attributes.Find(AttributeName);
+	}
+
+	OutAttribute = Hint->Attribute;
+	if (!Hint->Attribute || Hint->Attribute->Keys.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const TArray<FRoadLaneAttributeKey>& Keys = Hint->Attribute->Keys;
+	const double LocalS = SOffset - LaneSOffset0;
+	auto IsActiveKey = [&Keys, LocalS](int KeyIndex)
+	{
+		return Keys.IsValidIndex(KeyIndex) && Keys[KeyIndex].SOffset <= LocalS && (KeyIndex + 1 == Keys.Num() || LocalS < Keys[KeyIndex + 1].SOffset);
+	};
+
+	if (!IsActiveKey(Hint->KeyIndex))
+	{
+		if (IsActiveKey(Hint->KeyIndex + 1))
+		{
+			++Hint->KeyIndex;
+		}
+		else if (IsActiveKey(Hint->KeyIndex - 1))
+		{
+			--Hint->KeyIndex;
+		}
+		else
+		{
+			Hint->KeyIndex = Hint->Attribute->FindKeyBeforeOrAt(LocalS);
+		}
+	}
+	return Hint->KeyIndex;
+}
+
+double FRoadLaneCursor::GetSpeedLimit() const
+{
+	const FRaodLaneSpeed* Speed = GetAttributeValue<FRaodLaneSpeed>(UnrealDrive::LaneAttributes::Speed);
+	return (Speed ? Speed->MaxSpeed : FRaodLaneSpeed{}.MaxSpeed) * 100.0;
+}
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "RoadLaneGraph.h"
+#include "RoadSplineComponent.h"
+#include "DefaultRoadLaneAttributes.h"
+#include "UnrealDrive.h"
+#include "Algo/Reverse.h"
+
+double FRoadLaneGraph::GetDefaultSpeed()
+{
+	return FRaodLaneSpeed{}.MaxSpeed * 100.0;
+}
+
+void FRoadLaneGraph::Reset()
+{
+	SplineNodes.Empty();
+	ConnectionsVersion = 0;
+	Nodes.Empty();
+	NodesMap.Empty();
+	Offsets.Empty();
+	Targets.Empty();
+	MaxSpeed = 0;
+}
+
+SIZE_T FRoadLaneGraph::GetAllocatedSize() const
+{
+	SIZE_T Size = SplineNodes.GetAllocatedSize() + Nodes.GetAllocatedSize() + NodesMap.GetAllocatedSize() + Offsets.GetAllocatedSize() + Targets.GetAllocatedSize();
+	for (const auto& It : SplineNodes)
+	{
+		Size += It.Value.Nodes.GetAllocatedSize();
+	}
+	return Size;
+}
+
+int FRoadLaneGraph::FindNode(const URoadSplineComponent* RoadSpline, int SectionIndex, int LaneIndex) const
+{
+	const int* NodeIndex = NodesMap.Find(MakeTuple(RoadSpline, SectionIndex, LaneIndex));
+	return NodeIndex ? *NodeIndex : INDEX_NONE;
+}
+
+double FRoadLaneGraph::EvalTravelTime(const FRoadLane& Lane, double S0, double S1, double* OutMaxSpeed)
+{
+	const double DefaultSpeed = GetDefaultSpeed();
+	double TravelTime = 0;
+	double CoveredLength = 0;
+	double LaneMaxSpeed = 0;
+
+	const FRoadLaneAttribute* SpeedAttribute = Lane.Attributes.Find(UnrealDrive::LaneAttributes::Speed);
+	if (SpeedAttribute && SpeedAttribute->GetScriptStruct() == FRaodLaneSpeed::StaticStruct())
+	{
+		SpeedAttribute->ForEachSpanInRange(S0, S1, [&](int KeyIndex, double SpanS0, double SpanS1)
+		{
+			const FRaodLaneSpeed* Speed = SpeedAttribute->Keys[KeyIndex].GetValuePtr<FRaodLaneSpeed>();
+			const double SpanSpeed = (Speed && Speed->MaxSpeed > UE_KINDA_SMALL_NUMBER) ? Speed->MaxSpeed * 100.0 : DefaultSpeed;
+			TravelTime += (SpanS1 - SpanS0) / SpanSpeed;
+			CoveredLength += SpanS1 - SpanS0;
+			LaneMaxSpeed = FMath::Max(LaneMaxSpeed, SpanSpeed);
+		});
+	}
+
+	// The part before the first key
+	const double UncoveredLength = (S1 - S0) - CoveredLength;
+	if (UncoveredLength > UE_KINDA_SMALL_NUMBER || CoveredLength == 0)
+	{
+		TravelTime += FMath::Max(UncoveredLength, 0.0) / DefaultSpeed;
+		LaneMaxSpeed = FMath::Max(LaneMaxSpeed, DefaultSpeed);
+	}
+
+	if (OutMaxSpeed)
+	{
+		*OutMaxSpeed = LaneMaxSpeed;
+	}
+	return TravelTime;
+}
+
+void FRoadLaneGraph::BuildSplineNodes(const URoadSplineComponent* RoadSpline, TArray<FNode>& OutNodes)
+{
+	OutNodes.Reset();
+
+	const TArray<FRoadLaneSection>& Sections = RoadSpline->GetLaneSections();
+	for (int SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
+	{
+		const FRoadLaneSection& Section = Sections[SectionIndex];
+
+		auto AddNode = [&](int LaneIndex)
+		{
+			const FRoadLane& Lane = Section.GetLaneByIndex(LaneIndex);
+			FNode& Node = OutNodes.AddDefaulted_GetRef();
+			Node.RoadSpline = RoadSpline;
+			Node.SectionIndex = SectionIndex;
+			Node.LaneIndex = LaneIndex;
+			Node.bIsForward = Lane.IsForwardLane();
+			Node.SOffset0 = Lane.GetStartOffset();
+			Node.SOffset1 = FMath::Max(Lane.GetEndOffset(), Node.SOffset0);
+			Node.TravelTime = EvalTravelTime(Lane, 0.0, Node.GetLength(), &Node.MaxSpeed);
+
+			const FVector Location0 = RoadSpline->EvalLanePoistion(SectionIndex, LaneIndex, Node.SOffset0, 0.5, ESplineCoordinateSpace::World);
+			const FVector Location1 = RoadSpline->EvalLanePoistion(SectionIndex, LaneIndex, Node.SOffset1, 0.5, ESplineCoordinateSpace::World);
+			Node.TravelStartLocation = Node.bIsForward ? Location0 : Location1;
+			Node.TravelEndLocation = Node.bIsForward ? Location1 : Location0;
+		};
+
+		for (int i = 0; i < Section.Right.Num(); ++i)
+		{
+			AddNode(i + 1);
+		}
+		for (int i = 0; i < Section.Left.Num(); ++i)
+		{
+			AddNode(-i - 1);
+		}
+	}
+}
+
+bool FRoadLaneGraph::Update(TConstArrayView<const URoadSplineComponent*> RoadSplines)
+{
+	check(IsInGameThread());
+
+	bool bIsChanged = false;
+
+	TSet<const URoadSplineComponent*> UsedSplines;
+	UsedSplines.Reserve(RoadSplines.Num());
+
+	for (const URoadSplineComponent* RoadSpline : RoadSplines)
+	{
+		check(RoadSpline);
+		UsedSplines.Add(RoadSpline);
+
+		const uint64 SplineCurvesVersion = RoadSpline->GetSplineCurvesVersion();
+		const uint64 LayoutVersion = RoadSpline->GetRoadLayout().GetLayoutVersion();
+		const uint64 AttributesVersion = RoadSpline->GetRoadLayout().GetAttributesVersion();
+		const FTransform& Transform = RoadSpline->GetComponentTransform();
+
+		FSplineNodes& Entry = SplineNodes.FindOrAdd(RoadSpline);
+		if (!Entry.bIsBuilt ||
+			Entry.SplineCurvesVersion != SplineCurvesVersion ||
+			Entry.LayoutVersion != LayoutVersion ||
+			Entry.AttributesVersion != AttributesVersion ||
+			!Entry.Transform.Equals(Transform, 0.0))
+		{
+			BuildSplineNodes(RoadSpline, Entry.Nodes);
+			Entry.SplineCurvesVersion = SplineCurvesVersion;
+			Entry.LayoutVersion = LayoutVersion;
+			Entry.AttributesVersion = AttributesVersion;
+			Entry.Transform = Transform;
+			Entry.bIsBuilt = true;
+			bIsChanged = true;
+		}
+	}
+
+	for (auto It = SplineNodes.CreateIterator(); It; ++It)
+	{
+		if (!UsedSplines.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+			bIsChanged = true;
+		}
+	}
+
+	if (!bIsChanged && ConnectionsVersion == URoadConnection::ConnectionsVersion)
+	{
+		return false;
+	}
+
+	ConnectionsVersion = URoadConnection::ConnectionsVersion;
+
+	if (bIsChanged)
+	{
+		Nodes.Reset();
+		NodesMap.Reset();
+		MaxSpeed = GetDefaultSpeed();
+		for (const URoadSplineComponent* RoadSpline : RoadSplines)
+		{
+			for (const FNode& Node : SplineNodes[RoadSpline].Nodes)
+			{
+				NodesMap.Add(MakeTuple(Node.RoadSpline, Node.SectionIndex, Node.LaneIndex), Nodes.Num());
+				Nodes.Add(Node);
+				MaxSpeed = FMath::Max(MaxSpeed, Node.MaxSpeed);
+			}
+		}
+	}
+
+	BuildEdges();
+
+	return true;
+}
+
+void FRoadLaneGraph::BuildEdges()
+{
+	Offsets.SetNumUninitialized(Nodes.Num() + 1);
+	Targets.Reset();
+
+	TArray<int, TInlineAllocator<8>> Successors;
+	for (int NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		Offsets[NodeIndex] = Targets.Num();
+		Successors.Reset();
+		AddLaneSuccessors(NodeIndex, Successors);
+		for (int Successor : Successors)
+		{
+			if (Successor != INDEX_NONE && !MakeArrayView(Targets.GetData() + Offsets[NodeIndex], Targets.Num() - Offsets[NodeIndex]).Contains(Successor))
+			{
+				Targets.Add(Successor);
+			}
+		}
+	}
+	Offsets[Nodes.Num()] = Targets.Num();
+}
+
+int FRoadLaneGraph::FindRoadEndNode(const URoadSplineComponent* RoadSpline, bool bAtStart, int Side, bool bDeparting) const
+{
+	const FRoadLayout& Layout = RoadSpline->GetRoadLayout();
+	if (Layout.Sections.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const int SectionIndex = Layout.FindSideSection(bAtStart ? 0 : Layout.Sections.Num() - 1, Side > 0 ? ERoadLaneSectionSide::Right : ERoadLaneSectionSide::Left);
+	if (SectionIndex < 0 || !Layout.Sections[SectionIndex].CheckLaneIndex(Side))
+	{
+		return INDEX_NONE;
+	}
+
+	const int NodeIndex = FindNode(RoadSpline, SectionIndex, Side);
+	if (NodeIndex == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	// Forward lanes depart from the road start and arrive to the road end
+	if ((Nodes[NodeIndex].bIsForward == bAtStart) != bDeparting)
+	{
+		return INDEX_NONE;
+	}
+	return NodeIndex;
+}
+
+/**
+ * A road attached to a lane connection has the reference line on the inner border of the lane (see ULaneConnection::SetTransform()),
+ * and it is directed along the lane. So the lane overlaps the road lane 1 or -1.
+ */
+static int GetAttachedRoadSide(int LaneIndex, bool bIsForwardLane)
+{
+	return ((LaneIndex > 0) == bIsForwardLane) ? 1 : -1;
+}
+
+void FRoadLaneGraph::AddLaneSuccessors(int NodeIndex, TArray<int, TInlineAllocator<8>>& OutSuccessors) const
+{
+	const FNode& Node = Nodes[NodeIndex];
+	const FRoadLayout& Layout = Node.RoadSpline->GetRoadLayout();
+	const FRoadLane& Lane = Layout.Sections[Node.SectionIndex].GetLaneByIndex(Node.LaneIndex);
+	const ERoadLaneSectionSide Side = Node.LaneIndex > 0 ? ERoadLaneSectionSide::Right : ERoadLaneSectionSide::Left;
+
+	// The next lane of the same road
+	if (Node.bIsForward)
+	{
+		const int NextSectionIndex = Lane.GetEndSectionIndex() + 1;
+		if (Layout.Sections.IsValidIndex(NextSectionIndex))
+		{
+			const int NextNode = FindNode(Node.RoadSpline, NextSectionIndex, Node.LaneIndex);
+			if (NextNode != INDEX_NONE && Nodes[NextNode].bIsForward)
+			{
+				OutSuccessors.Add(NextNode);
+			}
+		}
+	}
+	else if (Node.SectionIndex > 0)
+	{
+		const int PrevSectionIndex = Layout.FindSideSection(Node.SectionIndex - 1, Side);
+		if (PrevSectionIndex >= 0 && Layout.Sections[PrevSectionIndex].CheckLaneIndex(Node.LaneIndex) &&
+			Layout.Sections[PrevSectionIndex].GetLaneByIndex(Node.LaneIndex).GetEndSectionIndex() == Node.SectionIndex - 1)
+		{
+			const int PrevNode = FindNode(Node.RoadSpline, PrevSectionIndex, Node.LaneIndex);
+			if (PrevNode != INDEX_NONE && !Nodes[PrevNode].bIsForward)
+			{
+				OutSuccessors.Add(PrevNode);
+			}
+		}
+	}
+
+	// The roads which start at the end of this lane
+	if (IsValid(Lane.SuccessorConnection))
+	{
+		const int RoadSide = GetAttachedRoadSide(Node.LaneIndex, Node.bIsForward);
+		for (const auto& It : Lane.SuccessorConnection->OuterRoadConnections)
+		{
+			const URoadConnection* RoadConnection = It.Get();
+			const URoadSplineComponent* OuterRoadSpline = RoadConnection ? RoadConnection->GetOwnedRoadSpline() : nullptr;
+			if (OuterRoadSpline && OuterRoadSpline->GetPredecessorConnection() == RoadConnection)
+			{
+				OutSuccessors.Add(FindRoadEndNode(OuterRoadSpline, true, RoadSide, true));
+			}
+		}
+	}
+
+	// The lane which starts at the end of this road
+	if (Node.bIsForward && FMath::Abs(Node.LaneIndex) == 1)
+	{
+		const URoadConnection* RoadConnection = Node.RoadSpline->GetSuccessorConnection();
+		const ULaneConnection* LaneConnection = RoadConnection ? RoadConnection->GetOuterConnection() : nullptr;
+		if (LaneConnection && LaneConnection->IsConnectionValid() && !LaneConnection->IsSuccessorConnection() &&
+			FindRoadEndNode(Node.RoadSpline, false, Node.LaneIndex, false) == NodeIndex)
+		{
+			const int OuterNode = FindNode(LaneConnection->GetOwnedRoadSpline(), LaneConnection->GetSectionIndex(), LaneConnection->GetLaneIndex());
+			if (OuterNode != INDEX_NONE && GetAttachedRoadSide(Nodes[OuterNode].LaneIndex, Nodes[OuterNode].bIsForward) == Node.LaneIndex)
+			{
+				OutSuccessors.Add(OuterNode);
+			}
+		}
+	}
+}
+
+int FRoadLaneGraph::ResolveNode(const FRoadLaneLocation& Location) const
+{
+	if (!Location.RoadSpline || Location.LaneIndex == LANE_INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	// The location can be given in any section covered by the lane
+	const FRoadLayout& Layout = Location.RoadSpline->GetRoadLayout();
+	if (!Layout.Sections.IsValidIndex(Location.SectionIndex))
+	{
+		return INDEX_NONE;
+	}
+	const int SectionIndex = Layout.FindSideSection(Location.SectionIndex, Location.LaneIndex > 0 ? ERoadLaneSectionSide::Right : ERoadLaneSectionSide::Left);
+	if (SectionIndex < 0 || !Layout.Sections[SectionIndex].CheckLaneIndex(Location.LaneIndex))
+	{
+		return INDEX_NONE;
+	}
+	return FindNode(Location.RoadSpline, Layout.Sections[SectionIndex].GetLaneByIndex(Location.LaneIndex).GetStartSectionIndex(), Location.LaneIndex);
+}
+
+bool FRoadLaneGraph::FindRoute(const FRoadLaneLocation& Start, const FRoadLaneLocation& Goal, FRoadLaneRoute& OutRoute, bool bUseHeuristic) const
+{
+	OutRoute = FRoadLaneRoute{};
+
+	const int StartNode = ResolveNode(Start);
+	const int GoalNode = ResolveNode(Goal);
+	if (StartNode == INDEX_NONE || GoalNode == INDEX_NONE)
+	{
+		return false;
+	}
+
+	auto GetLane = [this](int NodeIndex) -> const FRoadLane&
+	{
+		const FNode& Node = Nodes[NodeIndex];
+		return Node.RoadSpline->GetLaneSections()[Node.SectionIndex].GetLaneByIndex(Node.LaneIndex);
+	};
+
+	// Lane local S of the start and the goal
+	const FNode& StartNodeRef = Nodes[StartNode];
+	const FNode& GoalNodeRef = Nodes[GoalNode];
+	const double StartS = FMath::Clamp(Start.SOffset - StartNodeRef.SOffset0, 0.0, StartNodeRef.GetLength());
+	const double GoalS = FMath::Clamp(Goal.SOffset - GoalNodeRef.SOffset0, 0.0, GoalNodeRef.GetLength());
+
+	// The goal is ahead on the same lane
+	if (StartNode == GoalNode && (StartNodeRef.bIsForward ? GoalS >= StartS : GoalS <= StartS))
+	{
+		const double S0 = FMath::Min(StartS, GoalS);
+		const double S1 = FMath::Max(StartS, GoalS);
+		OutRoute.Nodes.Add(StartNode);
+		OutRoute.TravelTime = EvalTravelTime(GetLane(StartNode), S0, S1);
+		OutRoute.Length = S1 - S0;
+		return true;
+	}
+
+	// Remaining part of the start lane and the part of the goal lane before the goal
+	const double StartS0 = StartNodeRef.bIsForward ? StartS : 0.0;
+	const double StartS1 = StartNodeRef.bIsForward ? StartNodeRef.GetLength() : StartS;
+	const double GoalS0 = GoalNodeRef.bIsForward ? 0.0 : GoalS;
+	const double GoalS1 = GoalNodeRef.bIsForward ? GoalS : GoalNodeRef.GetLength();
+	const double StartTime = EvalTravelTime(GetLane(StartNode), StartS0, StartS1);
+	const double GoalTime = EvalTravelTime(GetLane(GoalNode), GoalS0, GoalS1);
+
+	// The goal is reached through the virtual node, so the goal lane can also be passed as a regular node (e.g. if the goal is behind the start on the same lane)
+	const int VirtualGoal = Nodes.Num();
+	const FVector GoalLocation = Goal.RoadSpline->EvalLanePoistion(GoalNodeRef.SectionIndex, GoalNodeRef.LaneIndex, GoalNodeRef.SOffset0 + GoalS, 0.5, ESplineCoordinateSpace::World);
+	const double InvMaxSpeed = (bUseHeuristic && MaxSpeed > 0) ? 1.0 / MaxSpeed : 0.0;
+
+	// Travel time to the end of the node. The heuristic is admissible since no lane is faster than MaxSpeed
+	auto Heuristic = [&](int NodeIndex)
+	{
+		return NodeIndex == VirtualGoal ? 0.0 : FVector::Dist(Nodes[NodeIndex].TravelEndLocation, GoalLocation) * InvMaxSpeed;
+	};
+
+	TArray<double> Costs;
+	Costs.Init(TNumericLimits<double>::Max(), Nodes.Num() + 1);
+	TArray<int> Parents;
+	Parents.Init(INDEX_NONE, Nodes.Num() + 1);
+
+	struct FOpenNode
+	{
+		double F;
+		double G;
+		int NodeIndex;
+	};
+	auto OpenPredicate = [](const FOpenNode& A, const FOpenNode& B) { return A.F < B.F; };
+	TArray<FOpenNode> Open;
+
+	auto Relax = [&](int NodeIndex, double G, int Parent)
+	{
+		if (G < Costs[NodeIndex])
+		{
+			Costs[NodeIndex] = G;
+			Parents[NodeIndex] = Parent;
+			Open.HeapPush(FOpenNode{ G + Heuristic(NodeIndex), G, NodeIndex }, OpenPredicate);
+		}
+	};
+
+	Relax(StartNode, StartTime, INDEX_NONE);
+
+	bool bFound = false;
+	while (Open.Num())
+	{
+		FOpenNode Top;
+		Open.HeapPop(Top, OpenPredicate, EAllowShrinking::No);
+
+		if (Top.NodeIndex == VirtualGoal)
+		{
+			bFound = true;
+			break;
+		}
+
+		// Outdated entry
+		if (Top.G > Costs[Top.NodeIndex])
+		{
+			continue;
+		}
+
+		for (int Successor : GetSuccessors(Top.NodeIndex))
+		{
+			if (Successor == GoalNode)
+			{
+				Relax(VirtualGoal, Top.G + GoalTime, Top.NodeIndex);
+			}
+			Relax(Successor, Top.G + Nodes[Successor].TravelTime, Top.NodeIndex);
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	OutRoute.TravelTime = Costs[VirtualGoal];
+	OutRoute.Length = (GoalS1 - GoalS0);
+	OutRoute.Nodes.Add(GoalNode);
+	for (int NodeIndex = Parents[VirtualGoal]; NodeIndex != INDEX_NONE; NodeIndex = Parents[NodeIndex])
+	{
+		OutRoute.Nodes.Add(NodeIndex);
+		OutRoute.Length += (NodeIndex == StartNode) ? (StartS1 - StartS0) : Nodes[NodeIndex].GetLength();
+	}
+	Algo::Reverse(OutRoute.Nodes);
+
+	return true;
+}
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "RoadLaneIndexSubsystem.h"
+#include "RoadSplineComponent.h"
+#include "UnrealDrive.h"
+#include "Async/ParallelFor.h"
+
+namespace RoadLaneIndex
+{
+	// Length of the road slices along S [cm]
+	static constexpr double SliceLength = 300.0;
+
+	// Min padding of the slice bounds [cm], added to the measured bulge of the curved slices
+	static constexpr double MinSlicePadding = 10.0;
+
+	// Number of the Newton steps to project a point to the spline
+	static constexpr int MaxProjectionSteps = 4;
+
+	static constexpr int MinBatchSize = 64;
+
+	/** Outer borders (ROffset) of the road layout at S */
+	static void EvalRoadBorders(const URoadSplineComponent* RoadSpline, double S, double& OutLeftROffset, double& OutRightROffset)
+	{
+		const FRoadLayout& Layout = RoadSpline->GetRoadLayout();
+		const double ROffset = RoadSpline->EvalROffset(S);
+		OutLeftROffset = ROffset;
+		OutRightROffset = ROffset;
+
+		const int SectionIndex = RoadSpline->FindRoadSectionOnSOffset(S);
+		if (SectionIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		const int LeftSectionIndex = Layout.FindSideSection(SectionIndex, ERoadLaneSectionSide::Left);
+		if (LeftSectionIndex >= 0 && Layout.Sections[LeftSectionIndex].Left.Num())
+		{
+			const FRoadLaneSection& Section = Layout.Sections[LeftSectionIndex];
+			OutLeftROffset += Section.EvalLaneROffset(-Section.Left.Num(), S, 1.0);
+		}
+
+		const int RightSectionIndex = Layout.FindSideSection(SectionIndex, ERoadLaneSectionSide::Right);
+		if (RightSectionIndex >= 0 && Layout.Sections[RightSectionIndex].Right.Num())
+		{
+			const FRoadLaneSection& Section = Layout.Sections[RightSectionIndex];
+			OutRightROffset += Section.EvalLaneROffset(Section.Right.Num(), S, 1.0);
+		}
+	}
+
+	/** Find the lane which contains the point (S, R) */
+	static bool FindLane(const URoadSplineComponent* RoadSpline, double S, double R, int& OutSectionIndex, int& OutLaneIndex)
+	{
+		const FRoadLayout& Layout = RoadSpline->GetRoadLayout();
+		const int SectionIndex = RoadSpline->FindRoadSectionOnSOffset(S);
+		if (SectionIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const double LaneR = R - RoadSpline->EvalROffset(S);
+		const bool bIsRight = LaneR >= 0.0;
+		const int SideSectionIndex = Layout.FindSideSection(SectionIndex, bIsRight ? ERoadLaneSectionSide::Right : ERoadLaneSectionSide::Left);
+		if (SideSectionIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const FRoadLaneSection& Section = Layout.Sections[SideSectionIndex];
+		const int NumLanes = bIsRight ? Section.Right.Num() : Section.Left.Num();
+		for (int i = 1; i <= NumLanes; ++i)
+		{
+			const int LaneIndex = bIsRight ? i : -i;
+			if (FMath::Abs(LaneR) <= FMath::Abs(Section.EvalLaneROffset(LaneIndex, S, 1.0)))
+			{
+				OutSectionIndex = SideSectionIndex;
+				OutLaneIndex = LaneIndex;
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+void URoadLaneIndexSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	EntryIndices.Empty();
+	EntriesBVH.Reset();
+	bEntriesBVHDirty = true;
+	LaneGraph.Reset();
+	JunctionConflicts.Reset();
+	bJunctionConflictsDirty = true;
+
+	Super::Deinitialize();
+}
+
+void URoadLaneIndexSubsystem::RegisterRoadSpline(const URoadSplineComponent* RoadSpline)
+{
+	check(IsInGameThread());
+
+	if (!RoadSpline)
+	{
+		return;
+	}
+
+	int& EntryIndex = EntryIndices.FindOrAdd(RoadSpline, INDEX_NONE);
+	if (EntryIndex == INDEX_NONE)
+	{
+		EntryIndex = Entries.AddDefaulted();
+		Entries[EntryIndex].RoadSpline = RoadSpline;
+	}
+
+	// The entry of a destroyed spline at the same address is reused too
+	FRoadSplineEntry& Entry = Entries[EntryIndex];
+	Entry.WeakRoadSpline = RoadSpline;
+	Entry.bIsDirty = true;
+}
+
+void URoadLaneIndexSubsystem::UnregisterRoadSpline(const URoadSplineComponent* RoadSpline)
+{
+	check(IsInGameThread());
+
+	if (const int* EntryIndex = EntryIndices.Find(RoadSpline))
+	{
+		RemoveEntryAtSwap(*EntryIndex);
+	}
+}
+
+void URoadLaneIndexSubsystem::RemoveEntryAtSwap(int EntryIndex)
+{
+	EntryIndices.Remove(Entries[EntryIndex].RoadSpline);
+	Entries.RemoveAtSwap(EntryIndex);
+	if (EntryIndex < Entries.Num())
+	{
+		EntryIndices[Entries[EntryIndex].RoadSpline] = EntryIndex;
+	}
+	bEntriesBVHDirty = true;
+}
+
+void URoadLaneIndexSubsystem::UpdateIndex()
+{
+	check(IsInGameThread());
+
+	for (int EntryIndex = Entries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+	{
+		FRoadSplineEntry& Entry = Entries[EntryIndex];
+		const URoadSplineComponent* RoadSpline = Entry.WeakRoadSpline.Get();
+		if (!RoadSpline)
+		{
+			RemoveEntryAtSwap(EntryIndex);
+			continue;
+		}
+
+		Entry.RoadSpline = RoadSpline;
+
+		const uint64 SplineCurvesVersion = RoadSpline->GetSplineCurvesVersion();
+		const uint64 LayoutVersion = RoadSpline->GetRoadLayout().GetLayoutVersion();
+		const FTransform& Transform = RoadSpline->GetComponentTransform();
+
+		if (Entry.bIsDirty ||
+			Entry.SplineCurvesVersion != SplineCurvesVersion ||
+			Entry.LayoutVersion != LayoutVersion ||
+			!Entry.Transform.Equals(Transform, 0.0))
+		{
+			BuildEntry(Entry);
+			Entry.SplineCurvesVersion = SplineCurvesVersion;
+			Entry.LayoutVersion = LayoutVersion;
+			Entry.Transform = Transform;
+			Entry.bIsDirty = false;
+			bEntriesBVHDirty = true;
+		}
+	}
+
+	if (bEntriesBVHDirty)
+	{
+		TArray<FBox> EntriesBounds;
+		EntriesBounds.Reserve(Entries.Num());
+		for (const FRoadSplineEntry& Entry : Entries)
+		{
+			EntriesBounds.Add(Entry.SlicesBVH.GetBounds());
+		}
+		EntriesBVH.Build(EntriesBounds, 2);
+		bEntriesBVHDirty = false;
+	}
+}
+
+void URoadLaneIndexSubsystem::BuildEntry(FRoadSplineEntry& Entry) const
+{
+	const URoadSplineComponent* RoadSpline = Entry.RoadSpline;
+
+	Entry.Slices.Reset();
+	Entry.SlicesBVH.Reset();
+
+	const double Length = RoadSpline->GetSplineLength();
+	if (RoadSpline->GetLaneSectionsNum() == 0 || Length <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	const int NumSlices = FMath::Max(1, FMath::CeilToInt(Length / RoadLaneIndex::SliceLength));
+
+	// The ends and the middle of each slice: the center, the left and the right border points
+	const int NumSamples = 2 * NumSlices + 1;
+	TArray<FVector> SamplePoints;
+	SamplePoints.SetNumUninitialized(NumSamples * 3);
+	for (int i = 0; i < NumSamples; ++i)
+	{
+		const double S = Length * i / (NumSamples - 1);
+		const float Key = RoadSpline->GetInputKeyValueAtDistanceAlongSpline(S);
+		const FVector Location = RoadSpline->GetLocationAtSplineInputKey(Key, ESplineCoordinateSpace::World);
+		const FVector RightVector = RoadSpline->GetRightVectorAtSplineInputKey(Key, ESplineCoordinateSpace::World);
+
+		double LeftROffset, RightROffset;
+		RoadLaneIndex::EvalRoadBorders(RoadSpline, S, LeftROffset, RightROffset);
+
+		SamplePoints[i * 3 + 0] = Location;
+		SamplePoints[i * 3 + 1] = Location + RightVector * LeftROffset;
+		SamplePoints[i * 3 + 2] = Location + RightVector * RightROffset;
+	}
+
+	TArray<FBox> SlicesBounds;
+	SlicesBounds.SetNumUninitialized(NumSlices);
+	Entry.Slices.SetNumUninitialized(NumSlices);
+	for (int i = 0; i < NumSlices; ++i)
+	{
+		Entry.Slices[i] = { Length * i / NumSlices, Length * (i + 1) / NumSlices };
+
+		const FVector* Start = &SamplePoints[(2 * i) * 3];
+		const FVector* Middle = Start + 3;
+		const FVector* End = Middle + 3;
+
+		// The deviation of the middle points from the chords bounds the bulge of both half slices beyond their sample points
+		FBox Bounds(ForceInit);
+		double Deviation = 0.0;
+		for (int k = 0; k < 3; ++k)
+		{
+			Bounds += Start[k];
+			Bounds += Middle[k];
+			Bounds += End[k];
+			Deviation = FMath::Max(Deviation, FVector::Dist(Middle[k], (Start[k] + End[k]) * 0.5));
+		}
+		SlicesBounds[i] = Bounds.ExpandBy(Deviation + RoadLaneIndex::MinSlicePadding);
+	}
+
+	Entry.SlicesBVH.Build(SlicesBounds);
+}
+
+bool URoadLaneIndexSubsystem::ProjectPointToSlice(const URoadSplineComponent* RoadSpline, const FSlice& Slice, const FVector& WorldPoint, double MaxHeight, FRoadLaneProjection& OutProjection)
+{
+	const double Length = RoadSpline->GetSplineLength();
+	const double MinS = FMath::Max(0.0, Slice.S0 - RoadLaneIndex::SliceLength);
+	const double MaxS = FMath::Min(Length, Slice.S1 + RoadLaneIndex::SliceLength);
+
+	// Start from the closest point of the slice chord
+	const FVector A = RoadSpline->GetLocationAtDistanceAlongSpline(Slice.S0, ESplineCoordinateSpace::World);
+	const FVector B = RoadSpline->GetLocationAtDistanceAlongSpline(Slice.S1, ESplineCoordinateSpace::World);
+	const double ChordSizeSquared = (B - A).SizeSquared();
+	const double Alpha = ChordSizeSquared > UE_SMALL_NUMBER ? FMath::Clamp(((WorldPoint - A) | (B - A)) / ChordSizeSquared, 0.0, 1.0) : 0.0;
+	double S = FMath::Lerp(Slice.S0, Slice.S1, Alpha);
+
+	// Refine along the spline direction
+	float Key = 0;
+	for (int Step = 0; Step < RoadLaneIndex::MaxProjectionSteps; ++Step)
+	{
+		Key = RoadSpline->GetInputKeyValueAtDistanceAlongSpline(S);
+		const FVector Location = RoadSpline->GetLocationAtSplineInputKey(Key, ESplineCoordinateSpace::World);
+		const FVector Direction = RoadSpline->GetDirectionAtSplineInputKey(Key, ESplineCoordinateSpace::World);
+		const double DeltaS = (WorldPoint - Location) | Direction;
+		S = FMath::Clamp(S + DeltaS, MinS, MaxS);
+		if (FMath::Abs(DeltaS) < UE_KINDA_SMALL_NUMBER * 10)
+		{
+			break;
+		}
+	}
+
+	Key = RoadSpline->GetInputKeyValueAtDistanceAlongSpline(S);
+	const FVector Location = RoadSpline->GetLocationAtSplineInputKey(Key, ESplineCoordinateSpace::World);
+	const FQuat Quat = RoadSpline->GetQuaternionAtSplineInputKey(Key, ESplineCoordinateSpace::World);
+	const FVector Delta = WorldPoint - Location;
+	const double Height = Delta | Quat.GetUpVector();
+	if (FMath::Abs(Height) > MaxHeight)
+	{
+		return false;
+	}
+
+	const double R = Delta | Quat.GetRightVector();
+	int SectionIndex, LaneIndex;
+	if (!RoadLaneIndex::FindLane(RoadSpline, S, R, SectionIndex, LaneIndex))
+	{
+		return false;
+	}
+
+	OutProjection.RoadSpline = RoadSpline;
+	OutProjection.SectionIndex = SectionIndex;
+	OutProjection.LaneIndex = LaneIndex;
+	OutProjection.SOffset = S;
+	OutProjection.ROffset = R;
+	OutProjection.Height = Height;
+	return true;
+}
+
+FRoadLaneProjection URoadLaneIndexSubsystem::ProjectPointInner(const FVector& WorldPoint, double MaxHeight) const
+{
+	FRoadLaneProjection Best;
+	const FBox QueryBox(WorldPoint - FVector(0, 0, MaxHeight), WorldPoint + FVector(0, 0, MaxHeight));
+
+	EntriesBVH.Query(QueryBox, [&](int EntryIndex)
+	{
+		const FRoadSplineEntry& Entry = Entries[EntryIndex];
+		Entry.SlicesBVH.Query(QueryBox, [&](int SliceIndex)
+		{
+			FRoadLaneProjection Candidate;
+			if (ProjectPointToSlice(Entry.RoadSpline, Entry.Slices[SliceIndex], WorldPoint, MaxHeight, Candidate))
+			{
+				if (!Best.IsValid() || FMath::Abs(Candidate.Height) < FMath::Abs(Best.Height))
+				{
+					Best = Candidate;
+				}
+			}
+			return true;
+		});
+		return true;
+	});
+
+	return Best;
+}
+
+void URoadLaneIndexSubsystem::ProjectPoints(TConstArrayView<FVector> WorldPoints, TArrayView<FRoadLaneProjection> OutProjections, double MaxHeight)
+{
+	check(OutProjections.Num() >= WorldPoints.Num());
+
+	UpdateIndex();
+
+	ParallelFor(TEXT("RoadLaneIndex.ProjectPoints"), WorldPoints.Num(), RoadLaneIndex::MinBatchSize, [&](int32 PointIndex)
+	{
+		OutProjections[PointIndex] = ProjectPointInner(WorldPoints[PointIndex], MaxHeight);
+	});
+}
+
+FRoadLaneProjection URoadLaneIndexSubsystem::ProjectPoint(const FVector& WorldPoint, double MaxHeight)
+{
+	UpdateIndex();
+	return ProjectPointInner(WorldPoint, MaxHeight);
+}
+
+const FRoadLaneGraph& URoadLaneIndexSubsystem::GetLaneGraph()
+{
+	check(IsInGameThread());
+
+	TArray<const URoadSplineComponent*> RoadSplines;
+	RoadSplines.Reserve(Entries.Num());
+	for (const FRoadSplineEntry& Entry : Entries)
+	{
+		if (const URoadSplineComponent* RoadSpline = Entry.WeakRoadSpline.Get())
+		{
+			RoadSplines.Add(RoadSpline);
+		}
+	}
+	if (LaneGraph.Update(RoadSplines))
+	{
+		bJunctionConflictsDirty = true;
+	}
+	return LaneGraph;
+}
+
+bool URoadLaneIndexSubsystem::FindRoute(const FRoadLaneLocation& Start, const FRoadLaneLocation& Goal, FRoadLaneRoute& OutRoute, bool bUseHeuristic)
+{
+	return GetLaneGraph().FindRoute(Start, Goal, OutRoute, bUseHeuristic);
+}
+
+const FRoadJunctionConflicts& URoadLaneIndexSubsystem::GetJunctionConflicts()
+{
+	const FRoadLaneGraph& Graph = GetLaneGraph();
+	if (bJunctionConflictsDirty)
+	{
+		JunctionConflicts.Build(Graph);
+		bJunctionConflictsDirty = false;
+	}
+	return JunctionConflicts;
+}
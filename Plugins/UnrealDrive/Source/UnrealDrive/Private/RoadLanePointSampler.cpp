@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#include "RoadLanePointSampler.h"
+#include "RoadSplineComponent.h"
+#include "Algo/Sort.h"
+
+bool FRoadLanePointSamplerFilter::Matches(const FRoadLane& Lane) const
+{
+	if (const FRoadLaneDriving* Driving = Lane.LaneInstance.GetPtr<FRoadLaneDriving>())
+	{
+		if (!DriveableLaneTypes.Contains(Driving->DriveableLaneType))
+		{
+			return false;
+		}
+	}
+	else if (Lane.LaneInstance.GetPtr<FRoadLaneSidewalk>())
+	{
+		if (!bSidewalks)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	for (const FName& AttributeName : RequiredAttributes)
+	{
+		if (!Lane.Attributes.Contains(AttributeName))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FRoadLanePointSampler::SetFilter(const FRoadLanePointSamplerFilter& InFilter)
+{
+	Filter = InFilter;
+	for (auto& It : SplineItems)
+	{
+		It.Value.bIsBuilt = false;
+	}
+}
+
+void FRoadLanePointSampler::Reset()
+{
+	SplineItems.Empty();
+	Splines.Empty();
+	SplineItemPtrs.Empty();
+	SplinesTable.Reset();
+}
+
+SIZE_T FRoadLanePointSampler::GetAllocatedSize() const
+{
+	SIZE_T Size = SplineItems.GetAllocatedSize() + Splines.GetAllocatedSize() + SplineItemPtrs.GetAllocatedSize() + SplinesTable.GetAllocatedSize();
+	for (const auto& It : SplineItems)
+	{
+		Size += It.Value.Lanes.GetAllocatedSize() + It.Value.LanesTable.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FRoadLanePointSampler::BuildSplineItem(const URoadSplineComponent* RoadSpline, FSplineItem& Item) const
+{
+	Item.Lanes.Reset();
+
+	TArray<double> Weights;
+	const TArray<FRoadLaneSection>& Sections = RoadSpline->GetLaneSections();
+	for (int SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
+	{
+		const FRoadLaneSection& Section = Sections[SectionIndex];
+		auto AddLane = [&](const FRoadLane& Lane, int LaneIndex)
+		{
+			const double S0 = Lane.GetStartOffset();
+			const double S1 = Lane.GetEndOffset();
+			if (S1 > S0 && Filter.Matches(Lane))
+			{
+				Item.Lanes.Add({ SectionIndex, LaneIndex, S0, S1, Lane.IsForwardLane() });
+				Weights.Add(S1 - S0);
+			}
+		};
+
+		for (int i = 0; i < Section.Right.Num(); ++i)
+		{
+			AddLane(Section.Right[i], i + 1);
+		}
+		for (int i = 0; i < Section.Left.Num(); ++i)
+		{
+			AddLane(Section.Left[i], -i - 1);
+		}
+	}
+
+	Item.LanesTable.Build(Weights);
+}
+
+bool FRoadLanePointSampler::Update(TConstArrayView<const URoadSplineComponent*> RoadSplines)
+{
+	check(IsInGameThread());
+
+	// New and removed splines are detected per item, the Splines has only the splines with the matched lanes
+	bool bIsChanged = false;
+
+	TSet<const URoadSplineComponent*> UsedSplines;
+	UsedSplines.Reserve(RoadSplines.Num());
+
+	for (const URoadSplineComponent* RoadSpline : RoadSplines)
+	{
+		check(RoadSpline);
+		UsedSplines.Add(RoadSpline);
+
+		const uint64 SplineCurvesVersion = RoadSpline->GetSplineCurvesVersion();
+		const uint64 LayoutVersion = RoadSpline->GetRoadLayout().GetLayoutVersion();
+		const uint64 AttributesVersion = RoadSpline->GetRoadLayout().GetAttributesVersion();
+
+		FSplineItem& Item = SplineItems.FindOrAdd(RoadSpline);
+		if (!Item.bIsBuilt || Item.SplineCurvesVersion != SplineCurvesVersion || Item.LayoutVersion != LayoutVersion || Item.AttributesVersion != AttributesVersion)
+		{
+			BuildSplineItem(RoadSpline, Item);
+			Item.SplineCurvesVersion = SplineCurvesVersion;
+			Item.LayoutVersion = LayoutVersion;
+			Item.AttributesVersion = AttributesVersion;
+			Item.bIsBuilt = true;
+			bIsChanged = true;
+		}
+	}
+
+	for (auto It = SplineItems.CreateIterator(); It; ++It)
+	{
+		if (!UsedSplines.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+			bIsChanged = true;
+		}
+	}
+
+	if (!bIsChanged)
+	{
+		return false;
+	}
+
+	// Only the top level table is rebuilt, it is O(number of the splines)
+	Splines.Reset();
+	SplineItemPtrs.Reset();
+	TArray<double> Weights;
+	Weights.Reserve(SplineItems.Num());
+	for (const auto& It : SplineItems)
+	{
+		if (!It.Value.LanesTable.IsEmpty())
+		{
+			Splines.Add(It.Key);
+			SplineItemPtrs.Add(&It.Value);
+			Weights.Add(It.Value.LanesTable.GetTotalWeight());
+		}
+	}
+	SplinesTable.Build(Weights);
+
+	return true;
+}
+
+void FRoadLanePointSampler::Sample(FRandomStream& RandomStream, int NumSamples, TArray<FRoadLanePointSample>& OutSamples) const
+{
+	if (IsEmpty() || NumSamples <= 0)
+	{
+		return;
+	}
+
+	struct FPending
+	{
+		int SplineIndex;
+		int SampleIndex;
+		bool bIsForward;
+	};
+
+	TArray<FPending> Pending;
+	Pending.SetNumUninitialized(NumSamples);
+
+	const int FirstSample = OutSamples.Num();
+	OutSamples.SetNum(FirstSample + NumSamples);
+
+	for (int i = 0; i < NumSamples; ++i)
+	{
+		const int SplineIndex = SplinesTable.Sample(RandomStream.GetFraction());
+		const FSplineItem& Item = *SplineItemPtrs[SplineIndex];
+		const FLaneItem& Lane = Item.Lanes[Item.LanesTable.Sample(RandomStream.GetFraction())];
+
+		FRoadLanePointSample& Sample = OutSamples[FirstSample + i];
+		Sample.RoadSpline = Splines[SplineIndex];
+		Sample.SectionIndex = Lane.SectionIndex;
+		Sample.LaneIndex = Lane.LaneIndex;
+		Sample.SOffset = FMath::Lerp(Lane.SOffset0, Lane.SOffset1, RandomStream.GetFraction());
+
+		Pending[i] = { SplineIndex, FirstSample + i, Lane.bIsForward };
+	}
+
+	// Evaluate the transforms per spline with the batched API
+	Algo::SortBy(Pending, &FPending::SplineIndex);
+
+	TArray<FRoadLanePositionQuery> Queries;
+	TArray<FRoadPosition> Positions;
+	for (int GroupStart = 0; GroupStart < Pending.Num();)
+	{
+		int GroupEnd = GroupStart + 1;
+		while (GroupEnd < Pending.Num() && Pending[GroupEnd].SplineIndex == Pending[GroupStart].SplineIndex)
+		{
+			++GroupEnd;
+		}
+
+		Queries.Reset();
+		for (int i = GroupStart; i < GroupEnd; ++i)
+		{
+			const FRoadLanePointSample& Sample = OutSamples[Pending[i].SampleIndex];
+			Queries.Add({ Sample.SectionIndex, Sample.LaneIndex, 0.5, Sample.SOffset });
+		}
+		Positions.SetNumUninitialized(Queries.Num());
+		Splines[Pending[GroupStart].SplineIndex]->GetRoadPositions(Queries, Positions, ESplineCoordinateSpace::World);
+
+		for (int i = GroupStart; i < GroupEnd; ++i)
+		{
+			const FRoadPosition& Position = Positions[i - GroupStart];
+			const FQuat Quat = Pending[i].bIsForward ? Position.Quat : Position.Quat * FQuat(FVector::UpVector, UE_PI);
+			OutSamples[Pending[i].SampleIndex].Transform = FTransform(Quat, Position.Location);
+		}
+
+		GroupStart = GroupEnd;
+	}
+}
@@ -36,9 +36,55 @@
 #include "UnrealDriveSubsystem.h"
 #include "SceneInterface.h"
 #include "SceneView.h"
+#include "Engine/World.h"
 
 using namespace UE::Geometry;
 
+DECLARE_STATS_GROUP(TEXT("UnrealDrive"), STATGROUP_UnrealDrive, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Road Scene Proxies"), STAT_RoadSceneProxies, STATGROUP_UnrealDrive);
+DECLARE_MEMORY_STAT(TEXT("Road Scene Proxies CPU Memory"), STAT_RoadSceneProxiesCPUMemory, STATGROUP_UnrealDrive);
+DECLARE_MEMORY_STAT(TEXT("Road Scene Proxies GPU Memory"), STAT_RoadSceneProxiesGPUMemory, STATGROUP_UnrealDrive);
+
+static FAutoConsoleCommand DumpRoadMemoryCommand(
+	TEXT("UnrealDrive.DumpRoadMemory"),
+	TEXT("Log the memory of the road spline scene proxies per road and per world."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		// The proxies are created and destroyed by the render commands
+		FlushRenderingCommands();
+
+		struct FWorldMemory
+		{
+			int NumRoads = 0;
+			SIZE_T CPUSize = 0;
+			SIZE_T GPUSize = 0;
+		};
+		TMap<const UWorld*, FWorldMemory> WorldsMemory;
+
+		for (TObjectIterator<URoadSplineComponent> It; It; ++It)
+		{
+			const FRoadSplineSceneProxy* Proxy = static_cast<const FRoadSplineSceneProxy*>(It->SceneProxy);
+			if (!Proxy || !It->GetWorld())
+			{
+				continue;
+			}
+
+			const SIZE_T CPUSize = sizeof(FRoadSplineSceneProxy) + Proxy->GetAllocatedSize();
+			const SIZE_T GPUSize = Proxy->GetGPUMemorySize();
+			UE_LOG(LogUnrealDrive, Log, TEXT("%s: CPU %.1f KB, GPU %.1f KB"), *It->GetPathName(), CPUSize / 1024.0, GPUSize / 1024.0);
+
+			FWorldMemory& WorldMemory = WorldsMemory.FindOrAdd(It->GetWorld());
+			++WorldMemory.NumRoads;
+			WorldMemory.CPUSize += CPUSize;
+			WorldMemory.GPUSize += GPUSize;
+		}
+
+		for (const auto& [World, WorldMemory] : WorldsMemory)
+		{
+			UE_LOG(LogUnrealDrive, Log, TEXT("World %s: %d roads, CPU %.1f KB, GPU %.1f KB"), *World->GetName(), WorldMemory.NumRoads, WorldMemory.CPUSize / 1024.0, WorldMemory.GPUSize / 1024.0);
+		}
+	}));
+
 
 #if WITH_EDITOR
 
@@ -90,11 +136,13 @@ public:
 	}
 };
 
-struct FTriProxy
+/**
+ * Geometry of the road direction arrow. It's the same for all roads, so it's allocated once per feature level and shared by all FTriProxy
+ */
+struct FTriProxyResources
 {
-	FTriProxy(const FTransform& Transform, ERHIFeatureLevel::Type InFeatureLevel)
-		: LocalTransform(Transform.ToMatrixNoScale())
-		, VertexFactory(InFeatureLevel, "FTriProxy")
+	FTriProxyResources(ERHIFeatureLevel::Type InFeatureLevel)
+		: VertexFactory(InFeatureLevel, "FTriProxy")
 	{
 		static const float Width = 20;
 		static const float Height = 20;
@@ -117,16 +165,9 @@ struct FTriProxy
 		BeginInitResource(&VertexBuffers.ColorVertexBuffer);
 		BeginInitResource(&VertexFactory);
 		BeginInitResource(&IndexBuffer);
-
-		Material = GetDefault<UUnrealDriveSettings>()->SplineArrowMatrtial->GetRenderProxy();
-	}
-
-	virtual ~FTriProxy()
-	{ 
-		ReleaseResources(); 
 	}
 
-	virtual void ReleaseResources()
+	~FTriProxyResources()
 	{
 		VertexBuffers.PositionVertexBuffer.ReleaseResource();
 		VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
@@ -135,6 +176,47 @@ struct FTriProxy
 		IndexBuffer.ReleaseResource();
 	}
 
+	/** The resources are created by the first proxy and released with the last one */
+	static TSharedRef<FTriProxyResources> Get(ERHIFeatureLevel::Type FeatureLevel)
+	{
+		static FCriticalSection Lock;
+		static TWeakPtr<FTriProxyResources> SharedResources[ERHIFeatureLevel::Num];
+
+		FScopeLock ScopeLock(&Lock);
+		TSharedPtr<FTriProxyResources> Resources = SharedResources[FeatureLevel].Pin();
+		if (!Resources.IsValid())
+		{
+			// The last proxy may be released on any thread, the render resources must be released on the render thread
+			Resources = TSharedPtr<FTriProxyResources>(new FTriProxyResources(FeatureLevel), [](FTriProxyResources* InResources)
+			{
+				ENQUEUE_RENDER_COMMAND(ReleaseTriProxyResources)([InResources](FRHICommandListImmediate& RHICmdList)
+				{
+					delete InResources;
+				});
+			});
+			SharedResources[FeatureLevel] = Resources;
+		}
+		return Resources.ToSharedRef();
+	}
+
+	FStaticMeshVertexBuffers VertexBuffers;
+	FDynamicMeshIndexBuffer32 IndexBuffer;
+	FLocalVertexFactory VertexFactory;
+};
+
+struct FTriProxy
+{
+	FTriProxy(const FTransform& Transform, ERHIFeatureLevel::Type InFeatureLevel)
+		: LocalTransform(Transform.ToMatrixNoScale())
+		, Resources(FTriProxyResources::Get(InFeatureLevel))
+	{
+		Material = GetDefault<UUnrealDriveSettings>()->SplineArrowMatrtial->GetRenderProxy();
+	}
+
+	virtual ~FTriProxy()
+	{ 
+	}
+
 	virtual FMeshBatch* GetDynamicMeshElements(const class FPrimitiveSceneProxy& SceneProxy, const FSceneView*& View, const FSceneViewFamily& ViewFamily, FPrimitiveDrawInterface* PDI, FMeshElementCollector& Collector) const
 	{
 		float ViewScale = static_cast<float>(View->WorldToScreen(SceneProxy.GetLocalToWorld().TransformPosition(LocalTransform.GetOrigin())).W * (4.0f / View->UnscaledViewRect.Width() / View->ViewMatrices.GetProjectionMatrix().M[0][0]));
@@ -153,29 +235,123 @@ struct FTriProxy
 
 		FMeshBatch& MeshBatch = Collector.AllocateMesh();
 		MeshBatch.MaterialRenderProxy = Material;
-		MeshBatch.VertexFactory = &VertexFactory;
+		MeshBatch.VertexFactory = &Resources->VertexFactory;
 		MeshBatch.ReverseCulling = SceneProxy.IsLocalToWorldDeterminantNegative();
 		MeshBatch.Type = PT_TriangleList;
 		MeshBatch.DepthPriorityGroup = SDPG_World;//SDPG_Foreground;
 		MeshBatch.bCanApplyViewModeOverrides = false;
 
 		FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
-		BatchElement.IndexBuffer = &IndexBuffer;
+		BatchElement.IndexBuffer = &Resources->IndexBuffer;
 		BatchElement.FirstIndex = 0;
-		BatchElement.NumPrimitives = IndexBuffer.Indices.Num() / 3;
+		BatchElement.NumPrimitives = Resources->IndexBuffer.Indices.Num() / 3;
 		BatchElement.MinVertexIndex = 0;
-		BatchElement.MaxVertexIndex = VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
+		BatchElement.MaxVertexIndex = Resources->VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
 		BatchElement.PrimitiveUniformBufferResource = &DynamicPrimitiveUniformBuffer.UniformBuffer;
 
 		return &MeshBatch;
 	}
 	FMatrix LocalTransform;
-	FStaticMeshVertexBuffers VertexBuffers;
-	FDynamicMeshIndexBuffer32 IndexBuffer;
-	FLocalVertexFactory VertexFactory;
+	TSharedRef<FTriProxyResources> Resources;
 	FMaterialRenderProxy* Material;
 };
 
+/** Bit of the lane type in the mask of the lane types of the road, see GetMaterialRelevance() */
+static uint64 GetLaneTypeBit(const TInstancedStruct<FRoadLaneInstance>& LaneInstance)
+{
+	if (const FRoadLaneDriving* DrivingLane = LaneInstance.GetPtr<FRoadLaneDriving>())
+	{
+		return 1ull << uint8(DrivingLane->DriveableLaneType);
+	}
+	if (LaneInstance.GetPtr<FRoadLaneSidewalk>())
+	{
+		return 1ull << 62;
+	}
+	return 1ull << 63;
+}
+
+/** Key of the cached relevance: the mask of the lane types, the hash of the materials they are drawn with and the feature level */
+using FMaterialRelevanceKey = TTuple<uint64, uint32, ERHIFeatureLevel::Type>;
+
+static FCriticalSection MaterialRelevanceLock;
+static TMap<FMaterialRelevanceKey, FMaterialRelevance> MaterialRelevanceCache;
+
+void ResetMaterialRelevanceCache()
+{
+	FScopeLock ScopeLock(&MaterialRelevanceLock);
+	MaterialRelevanceCache.Reset();
+}
+
+/** 
+ * Relevance of the materials the road can be drawn with. The lane materials depend only on the lane types, so the relevance is cached per set of the lane types
+ * and of their materials. The cache is reset when a material is recompiled, see ResetMaterialRelevanceCache()
+ */
+static FMaterialRelevance GetMaterialRelevance(const URoadSplineComponent* Component, ERHIFeatureLevel::Type FeatureLevel)
+{
+	const FRoadLayout& Layout = Component->GetRoadLayout();
+
+	TArray<const TInstancedStruct<FRoadLaneInstance>*, TInlineAllocator<32>> LaneInstances;
+	for (const FRoadLaneSection& Section : Layout.Sections)
+	{
+		for (const FRoadLane& Lane : Section.Left)
+		{
+			LaneInstances.Add(&Lane.LaneInstance);
+		}
+		for (const FRoadLane& Lane : Section.Right)
+		{
+			LaneInstances.Add(&Lane.LaneInstance);
+		}
+	}
+	if (Component->IsClosedLoop() && Layout.FilledInstance.IsValid())
+	{
+		LaneInstances.Add(&Layout.FilledInstance);
+	}
+
+	// The lane materials are overridden for the selection states, see FRoadSplineSceneProxy::GetDynamicMeshElements()
+	const UUnrealDriveSettings* Settings = GetDefault<UUnrealDriveSettings>();
+	TArray<const UMaterialInterface*, TInlineAllocator<16>> Materials = { Settings->SplineArrowMatrtial.Get(), Settings->SelectedLaneMatrtial.Get(), Settings->HiddenLaneMatrtial.Get() };
+
+	// One material per lane type, in the order of the lane type bits so the hash doesn't depend on the order of the lanes
+	uint64 LaneTypes = 0;
+	TArray<TPair<uint64, const UMaterialInterface*>, TInlineAllocator<16>> LaneMaterials;
+	for (const TInstancedStruct<FRoadLaneInstance>* LaneInstance : LaneInstances)
+	{
+		const uint64 LaneTypeBit = GetLaneTypeBit(*LaneInstance);
+		if (!(LaneTypes & LaneTypeBit))
+		{
+			LaneTypes |= LaneTypeBit;
+			LaneMaterials.Add({ LaneTypeBit, UUnrealDriveSettings::GetLaneMatrtial(*LaneInstance) });
+		}
+	}
+	LaneMaterials.Sort([](const auto& A, const auto& B) { return A.Key < B.Key; });
+	for (const auto& LaneMaterial : LaneMaterials)
+	{
+		Materials.Add(LaneMaterial.Value);
+	}
+
+	uint32 MaterialsHash = 0;
+	for (const UMaterialInterface* Material : Materials)
+	{
+		MaterialsHash = HashCombineFast(MaterialsHash, GetTypeHash(Material));
+	}
+	const FMaterialRelevanceKey Key(LaneTypes, MaterialsHash, FeatureLevel);
+
+	FScopeLock ScopeLock(&MaterialRelevanceLock);
+	if (const FMaterialRelevance* Found = MaterialRelevanceCache.Find(Key))
+	{
+		return *Found;
+	}
+
+	FMaterialRelevance MaterialRelevance{};
+	for (const UMaterialInterface* Material : Materials)
+	{
+		MaterialRelevance |= Material->GetRelevance_Concurrent(FeatureLevel);
+	}
+
+	MaterialRelevanceCache.Add(Key, MaterialRelevance);
+	return MaterialRelevance;
+}
+
 }
 
 static FPrimitiveSceneProxyDesc MakePrimitiveSceneProxyDes(const UPrimitiveComponent* Component)
@@ -187,38 +363,42 @@ static FPrimitiveSceneProxyDesc MakePrimitiveSceneProxyDes(const UPrimitiveCompo
 	return Desc;
 }
 
-FRoadSplineSceneProxy::FRoadSplineSceneProxy(URoadSplineComponent* Component)
+FRoadSplineSceneProxy::FRoadSplineSceneProxy(URoadSplineComponent* Component, TSharedPtr<const UnrealDrive::FRoadMeshData> InMeshData)
 	: FPrimitiveSceneProxy(MakePrimitiveSceneProxyDes(Component), NAME_None)
 	, RoadSpline(Component)
-	, bIsMultiRoad(Component->GetOwner()->K2_GetComponentsByClass(URoadSplineComponent::StaticClass()).Num() > 1)
-
+	, MeshData(MoveTemp(InMeshData))
 {
 	Subsystem = Component->GetWorld()->GetSubsystem<UUnrealDriveSubsystem>();
 
+	// The subsystem counts the road splines of the actors, it exists only in the editor and PIE worlds
+#if WITH_EDITOR
+	if (Subsystem)
+	{
+		bIsMultiRoad = Subsystem->IsMultiRoadActor(Component->GetOwner());
+	}
+	else
+#endif
+	{
+		int NumRoadSplines = 0;
+		Component->GetOwner()->ForEachComponent<URoadSplineComponent>(false, [&NumRoadSplines](URoadSplineComponent*) { ++NumRoadSplines; });
+		bIsMultiRoad = NumRoadSplines > 1;
+	}
+
 	bWantsSelectionOutline = false;
 	
-	LanesProxies = UnrealDrive::FLaneProxy::MakeLaneProxysFromSpline(Component, GetScene().GetFeatureLevel());
-
-	if (Component->IsClosedLoop() && Component->GetRoadLayout().FilledInstance.IsValid())
+	// The MeshData may be not ready yet (see URoadSplineComponent::GetRoadMeshData()), the proxy is recreated when the build is finished
+	if (MeshData)
 	{
-		LanesProxies.Add(UnrealDrive::FLaneProxy::MakeLoopProxyFromSpline(Component, GetScene().GetFeatureLevel()));
+		LanesProxies = UnrealDrive::FLaneProxy::MakeLaneProxies(*MeshData, GetScene().GetFeatureLevel(), MeshBuffers);
 	}
 
+	// The lanes are hit tested individually in the editor world, so they can't be merged there
+	bMergeLaneBatches = Component->GetWorld()->IsGameWorld();
+
 	//float Step = (Component->GetSplineLength() / SPLINE_DRAW_ARROW_STEP < 1.0) ? Component->GetSplineLength() / 2 : SPLINE_DRAW_ARROW_STEP;
 	//if(Step < )
 
-	for (auto& It : GetDefault<UUnrealDriveSettings>()->DriveableLaneMatrtials)
-	{
-		MaterialRelevance |= It.Value->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
-	}
-
-	//MaterialRelevance |= GetDefault<UUnrealDriveSettings>()->CurbLaneMatrtial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
-	
-	MaterialRelevance |= GetDefault<UUnrealDriveSettings>()->SplineArrowMatrtial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
-	MaterialRelevance |= GetDefault<UUnrealDriveSettings>()->SidewalkMatrtial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
-	MaterialRelevance |= GetDefault<UUnrealDriveSettings>()->SelectedLaneMatrtial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
-	MaterialRelevance |= GetDefault<UUnrealDriveSettings>()->EmptyLaneMatrtial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
-	MaterialRelevance |= GetDefault<UUnrealDriveSettings>()->HiddenLaneMatrtial->GetRelevance_Concurrent(GetScene().GetFeatureLevel());
+	MaterialRelevance = UnrealDrive::GetMaterialRelevance(Component, GetScene().GetFeatureLevel());
 
 	/*
 	static const int NumStep = 6;
@@ -233,10 +413,29 @@ FRoadSplineSceneProxy::FRoadSplineSceneProxy(URoadSplineComponent* Component)
 	*/
 
 	TriProxy = MakeShared<UnrealDrive::FTriProxy>(Component->GetTransformAtDistanceAlongSpline(0.0, ESplineCoordinateSpace::Local), GetScene().GetFeatureLevel());
+
+	// Everything below is immutable for the proxy lifetime, so the memory is counted once. The arrow geometry is shared by all proxies and isn't counted
+	LanesAllocatedSize = LanesProxies.GetAllocatedSize() + LanesProxies.Num() * sizeof(UnrealDrive::FLaneProxy) + MeshBuffers.GetAllocatedSize() + sizeof(UnrealDrive::FTriProxy);
+	if (MeshData)
+	{
+		LanesAllocatedSize += sizeof(UnrealDrive::FRoadMeshData) + MeshData->GetAllocatedSize();
+	}
+	for (const auto& Buffers : MeshBuffers)
+	{
+		LanesAllocatedSize += sizeof(UnrealDrive::FRoadMeshBuffers) + Buffers->GetAllocatedSize();
+		GPUMemorySize += Buffers->GetGPUMemorySize();
+	}
+
+	INC_DWORD_STAT(STAT_RoadSceneProxies);
+	INC_MEMORY_STAT_BY(STAT_RoadSceneProxiesCPUMemory, sizeof(*this) + LanesAllocatedSize);
+	INC_MEMORY_STAT_BY(STAT_RoadSceneProxiesGPUMemory, GPUMemorySize);
 }
 
 FRoadSplineSceneProxy::~FRoadSplineSceneProxy()
 {
+	DEC_DWORD_STAT(STAT_RoadSceneProxies);
+	DEC_MEMORY_STAT_BY(STAT_RoadSceneProxiesCPUMemory, sizeof(*this) + LanesAllocatedSize);
+	DEC_MEMORY_STAT_BY(STAT_RoadSceneProxiesGPUMemory, GPUMemorySize);
 }
 
 void FRoadSplineSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const
@@ -245,6 +444,9 @@ void FRoadSplineSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView
 
 	TTuple<int, int> SelectedLane =  RoadSpline->GetSelectedLane();
 
+	// Otherwise the lane meshes are drawn by the cached mesh draw commands (see DrawStaticElements())
+	const bool bDynamicLaneMeshes = UseDynamicLaneMeshes();
+
 	for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
 	{
 		if (VisibilityMap & (1 << ViewIndex))
@@ -252,9 +454,34 @@ void FRoadSplineSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView
 			const FSceneView* View = Views[ViewIndex];
 			FPrimitiveDrawInterface* PDI = Collector.GetPDI(ViewIndex);
 
+			// Long roads are mostly out of the view, so the lanes are culled per section chunk and the LOD is selected per section chunk
+			TArray<bool, TInlineAllocator<64>> ChunkVisibility;
+			TArray<int, TInlineAllocator<64>> ChunkLODs;
+			if (MeshData)
+			{
+				ChunkVisibility.SetNumUninitialized(MeshData->Chunks.Num());
+				ChunkLODs.SetNumZeroed(MeshData->Chunks.Num());
+				for (int ChunkIndex = 0; ChunkIndex < MeshData->Chunks.Num(); ++ChunkIndex)
+				{
+					const UnrealDrive::FRoadMeshChunk& Chunk = *MeshData->Chunks[ChunkIndex];
+					const FBox WorldBounds = Chunk.Bounds.IsValid ? Chunk.Bounds.TransformBy(MyLocalToWorld) : Chunk.Bounds;
+					ChunkVisibility[ChunkIndex] = WorldBounds.IsValid && View->ViewFrustum.IntersectBox(WorldBounds.GetCenter(), WorldBounds.GetExtent());
+					if (ChunkVisibility[ChunkIndex] && bDynamicLaneMeshes)
+					{
+						ChunkLODs[ChunkIndex] = Chunk.ComputeLOD(ComputeBoundsScreenSize(WorldBounds.GetCenter(), WorldBounds.GetExtent().Size(), *View));
+					}
+				}
+			}
+
 			for (const auto& Lane : LanesProxies)
 			{
-				if (FMeshBatch* MeshBatch = Lane->GetDynamicMeshElements(*this, View, ViewFamily, PDI, Collector))
+				if (ChunkVisibility.IsValidIndex(Lane->ChunkIndex) && !ChunkVisibility[Lane->ChunkIndex])
+				{
+					continue;
+				}
+
+				const int LODIndex = ChunkLODs.IsValidIndex(Lane->ChunkIndex) ? ChunkLODs[Lane->ChunkIndex] : 0;
+				if (FMeshBatch* MeshBatch = bDynamicLaneMeshes ? Lane->GetDynamicMeshElements(*this, View, ViewFamily, PDI, Collector, LODIndex) : nullptr)
 				{
 					if (bIsMultiRoad && IsParentSelected() && !IsIndividuallySelected())
 					{
@@ -303,13 +530,60 @@ void FRoadSplineSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView
 
 void FRoadSplineSceneProxy::DrawStaticElements(FStaticPrimitiveDrawInterface* PDI)
 {
-	/*
-	PDI->ReserveMemoryForMeshes(LanesProxies.Num());
+	if (bMergeLaneBatches)
+	{
+		int NumBatches = 0;
+		for (const auto& Buffers : MeshBuffers)
+		{
+			NumBatches += Buffers->MaterialBatches.Num();
+		}
+		PDI->ReserveMemoryForMeshes(NumBatches);
+		for (const auto& Buffers : MeshBuffers)
+		{
+			Buffers->DrawStaticElements(*this, PDI);
+		}
+		return;
+	}
+
+	int NumMeshes = 0;
 	for (const auto& Lane : LanesProxies)
 	{
+		NumMeshes += Lane->NumLODs;
+	}
+	PDI->ReserveMemoryForMeshes(NumMeshes);
+	for (const auto& Lane : LanesProxies)
+	{
+#if WITH_EDITOR
+		PDI->SetHitProxy(Lane->HitProxy);
+#endif
 		Lane->DrawStaticElements(*this, PDI);
 	}
-	*/
+#if WITH_EDITOR
+	PDI->SetHitProxy(nullptr);
+#endif
+}
+
+bool FRoadSplineSceneProxy::UseDynamicLaneMeshes() const
+{
+	// The material of the lanes is overridden per frame for these selection states, see GetDynamicMeshElements()
+	if (bIsMultiRoad && IsParentSelected() && !IsIndividuallySelected())
+	{
+		return true;
+	}
+
+	if (RoadSpline->GetSelectedLane().Get<0>() != INDEX_NONE)
+	{
+		return true;
+	}
+
+#if WITH_EDITOR
+	if (!IsParentSelected() && Subsystem && Subsystem->GetRoadSplineWasSelected())
+	{
+		return true;
+	}
+#endif
+
+	return false;
 }
 
 FPrimitiveViewRelevance FRoadSplineSceneProxy::GetViewRelevance(const FSceneView* View) const
@@ -317,8 +591,9 @@ FPrimitiveViewRelevance FRoadSplineSceneProxy::GetViewRelevance(const FSceneView
 	FPrimitiveViewRelevance Result;
 	Result.bDrawRelevance = IsShown(View);
 	Result.bShadowRelevance = false;// IsShadowCast(View);
+	// Lines and the arrow are always dynamic
 	Result.bDynamicRelevance = true;
-	//Result.bStaticRelevance = true;
+	Result.bStaticRelevance = !UseDynamicLaneMeshes();
 	Result.bRenderInMainPass = ShouldRenderInMainPass();
 	//Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
 	Result.bRenderCustomDepth = ShouldRenderCustomDepth();
@@ -344,9 +619,13 @@ HHitProxy* FRoadSplineSceneProxy::CreateHitProxies(UPrimitiveComponent* Componen
 #if WITH_EDITOR
 	OutHitProxies.Reserve(OutHitProxies.Num() + LanesProxies.Num());
 
+	// The MeshData is stale while its async rebuild is running (see URoadSplineComponent::GetRoadMeshData())
+	const URoadSplineComponent* RoadSplineComponent = CastChecked<URoadSplineComponent>(Component);
+	const bool bIsLayoutUpToDate = MeshData && MeshData->IsUpToDate(RoadSplineComponent);
+
 	for (auto & It : LanesProxies)
 	{
-		if (HRoadSplineVisProxy* HitProxy = It->CreateHitProxy(CastChecked<URoadSplineComponent>(Component)))
+		if (HRoadSplineVisProxy* HitProxy = It->CreateHitProxy(RoadSplineComponent, bIsLayoutUpToDate))
 		{
 			OutHitProxies.Add(HitProxy);
 		}
@@ -13,11 +13,17 @@
 #include "UnrealDriveSettings.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "UnrealDrive.h"
+#include "RoadLaneIndexSubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
 
 
 #if WITH_EDITOR
 #include "UnrealDriveSubsystem.h"
 #include "RoadSceneProxy.h"
+#include "Async/Async.h"
+#include "LaneProxy.h"
 #endif
 
 #define LOCTEXT_NAMESPACE "URoadSplineComponent"
@@ -204,11 +210,17 @@ void URoadSplineComponent::VapidateConnections()
 
 void URoadSplineComponent::UpdateSpline()
 {	
+	if (UpdateSplinePartial())
+	{
+		return;
+	}
+
 	//SetClosedLoop(false, false);
 	FixUpSegments();
 	UpdateAutoTangents();
 	Super::UpdateSpline();
 	UpdateLaneSectionBounds();
+	UpdateSplineSnapshot();
 	/*
 	for (auto& Section : Sections)
 	{
@@ -224,13 +236,207 @@ void URoadSplineComponent::UpdateSpline()
 	*/
 }
 
+void URoadSplineComponent::UpdateSpline(TConstArrayView<int> EditingPointIndices)
+{
+	if (UpdateSplinePartial())
+	{
+		return;
+	}
+
+	FixUpSegments();
+	for (int EditingPointIndex : EditingPointIndices)
+	{
+		UpdateAutoTangents(EditingPointIndex);
+	}
+	Super::UpdateSpline();
+	UpdateLaneSectionBounds();
+	UpdateSplineSnapshot();
+}
+
+template <typename T>
+static bool IsSameCurvePoint(const FInterpCurvePoint<T>& A, const FInterpCurvePoint<T>& B)
+{
+	return A.InVal == B.InVal && A.OutVal == B.OutVal && A.ArriveTangent == B.ArriveTangent && A.LeaveTangent == B.LeaveTangent && A.InterpMode == B.InterpMode;
+}
+
+/** Run FInterpCurve::AutoSetTangents() over points [SubFirst..SubLast], but write back tangents of points [CopyFirst..CopyLast] only */
+template <typename T>
+static void AutoSetTangentsInRange(FInterpCurve<T>& Curve, int SubFirst, int SubLast, int CopyFirst, int CopyLast, bool bStationaryEndpoints)
+{
+	FInterpCurve<T> SubCurve;
+	SubCurve.Points.Append(&Curve.Points[SubFirst], SubLast - SubFirst + 1);
+	SubCurve.AutoSetTangents(0.0f, bStationaryEndpoints);
+	for (int i = CopyFirst; i <= CopyLast; ++i)
+	{
+		Curve.Points[i].ArriveTangent = SubCurve.Points[i - SubFirst].ArriveTangent;
+		Curve.Points[i].LeaveTangent = SubCurve.Points[i - SubFirst].LeaveTangent;
+	}
+}
+
+bool URoadSplineComponent::UpdateSplinePartial()
+{
+	// Max number of the edited points which still can be updated partially
+	static constexpr int MaxEditedPoints = 4;
+
+	// Auto tangent of a point depends on the neighbour points, so the edited point affects tangents of [i-1..i+1] and segments [i-2..i+1]
+	static constexpr int WindowExtent = 2;
+
+	const int NumPoints = GetNumberOfSplinePoints();
+	const int Steps = ReparamStepsPerSegment;
+	const FVector Scale3D = GetComponentTransform().GetScale3D();
+	FSplineUpdateSnapshot& Snapshot = SplineUpdateSnapshot;
+
+	if (!Snapshot.bIsValid 
+		|| IsClosedLoop() 
+		|| NumPoints < 2 
+		|| Steps <= 0
+		|| Snapshot.Position.Num() != NumPoints
+		|| Snapshot.Rotation.Num() != SplineCurves.Rotation.Points.Num()
+		|| Snapshot.Scale.Num() != SplineCurves.Scale.Points.Num()
+		|| SplineCurves.Rotation.Points.Num() != NumPoints
+		|| SplineCurves.Scale.Points.Num() != NumPoints
+		|| Snapshot.ReparamStepsPerSegment != Steps
+		|| Snapshot.bStationaryEndpoints != bStationaryEndpoints
+		|| !Snapshot.Scale3D.Equals(Scale3D, 0.0)
+		|| PointTypes.Num() != NumPoints
+		|| Snapshot.PointTypes.Num() != NumPoints
+		|| SplineCurves.ReparamTable.Points.Num() != (NumPoints - 1) * Steps + 1)
+	{
+		return false;
+	}
+
+	// Find edited points
+	TArray<int, TInlineAllocator<MaxEditedPoints>> EditedPoints;
+	for (int i = 0; i < NumPoints; ++i)
+	{
+		if (!IsSameCurvePoint(Snapshot.Position[i], SplineCurves.Position.Points[i]) ||
+			!IsSameCurvePoint(Snapshot.Rotation[i], SplineCurves.Rotation.Points[i]) ||
+			!IsSameCurvePoint(Snapshot.Scale[i], SplineCurves.Scale.Points[i]) ||
+			Snapshot.PointTypes[i] != PointTypes[i])
+		{
+			if (EditedPoints.Num() == MaxEditedPoints)
+			{
+				return false;
+			}
+			EditedPoints.Add(i);
+		}
+	}
+
+	// Group the edited points to the windows of affected points
+	struct FWindow
+	{
+		int First;
+		int Last;
+	};
+	TArray<FWindow, TInlineAllocator<MaxEditedPoints>> Windows;
+	for (int PointIndex : EditedPoints)
+	{
+		if (Windows.Num() && PointIndex - Windows.Last().Last <= WindowExtent * 2)
+		{
+			Windows.Last().Last = PointIndex;
+		}
+		else
+		{
+			Windows.Add({ PointIndex, PointIndex });
+		}
+	}
+
+	// Arc segments are normalized in chains by UpdateAutoTangents(), which isn't local
+	for (const FWindow& Window : Windows)
+	{
+		for (int i = FMath::Max(0, Window.First - WindowExtent); i <= FMath::Min(NumPoints - 1, Window.Last + WindowExtent); ++i)
+		{
+			if (PointTypes[i] == ERoadSplinePointTypeOverride::Arc || SplineCurves.Position.Points[i].InVal != i)
+			{
+				return false;
+			}
+		}
+	}
+
+	auto& Table = SplineCurves.ReparamTable.Points;
+	float Delta = 0.0f;
+	int ShiftedIndex = 0;
+
+	for (const FWindow& Window : Windows)
+	{
+		const int SubFirst = FMath::Max(0, Window.First - WindowExtent);
+		const int SubLast = FMath::Min(NumPoints - 1, Window.Last + WindowExtent);
+		const int CopyFirst = FMath::Max(0, Window.First - 1);
+		const int CopyLast = FMath::Min(NumPoints - 1, Window.Last + 1);
+
+		AutoSetTangentsInRange(SplineCurves.Position, SubFirst, SubLast, CopyFirst, CopyLast, bStationaryEndpoints);
+		AutoSetTangentsInRange(SplineCurves.Rotation, SubFirst, SubLast, CopyFirst, CopyLast, bStationaryEndpoints);
+		AutoSetTangentsInRange(SplineCurves.Scale, SubFirst, SubLast, CopyFirst, CopyLast, bStationaryEndpoints);
+
+		const int FirstSegment = SubFirst;
+		const int LastSegment = FMath::Min(NumPoints - 2, Window.Last + 1);
+
+		// Shift the table entries between the previous window and this one
+		for (; ShiftedIndex <= FirstSegment * Steps; ++ShiftedIndex)
+		{
+			Table[ShiftedIndex].InVal += Delta;
+		}
+
+		// Splice the entries of the affected segments
+		const float OldEndLength = Table[(LastSegment + 1) * Steps].InVal;
+		float AccumulatedLength = Table[FirstSegment * Steps].InVal;
+		for (int SegmentIndex = FirstSegment; SegmentIndex <= LastSegment; ++SegmentIndex)
+		{
+			for (int Step = 1; Step < Steps; ++Step)
+			{
+				const float Param = static_cast<float>(Step) / Steps;
+				Table[SegmentIndex * Steps + Step].InVal = AccumulatedLength + SplineCurves.GetSegmentLength(SegmentIndex, Param, false, Scale3D);
+			}
+			AccumulatedLength += SplineCurves.GetSegmentLength(SegmentIndex, 1.0f, false, Scale3D);
+			Table[(SegmentIndex + 1) * Steps].InVal = AccumulatedLength;
+		}
+		Delta = AccumulatedLength - OldEndLength;
+		ShiftedIndex = (LastSegment + 1) * Steps + 1;
+
+		for (int i = SubFirst; i <= SubLast; ++i)
+		{
+			Snapshot.Position[i] = SplineCurves.Position.Points[i];
+			Snapshot.Rotation[i] = SplineCurves.Rotation.Points[i];
+			Snapshot.Scale[i] = SplineCurves.Scale.Points[i];
+			Snapshot.PointTypes[i] = PointTypes[i];
+		}
+	}
+
+	for (; ShiftedIndex < Table.Num(); ++ShiftedIndex)
+	{
+		Table[ShiftedIndex].InVal += Delta;
+	}
+
+	++SplineCurves.Version;
+	UpdateLaneSectionBounds();
+	return true;
+}
+
+void URoadSplineComponent::UpdateSplineSnapshot()
+{
+	SplineUpdateSnapshot.Position = SplineCurves.Position.Points;
+	SplineUpdateSnapshot.Rotation = SplineCurves.Rotation.Points;
+	SplineUpdateSnapshot.Scale = SplineCurves.Scale.Points;
+	SplineUpdateSnapshot.PointTypes = PointTypes;
+	SplineUpdateSnapshot.Scale3D = GetComponentTransform().GetScale3D();
+	SplineUpdateSnapshot.ReparamStepsPerSegment = ReparamStepsPerSegment;
+	SplineUpdateSnapshot.bStationaryEndpoints = bStationaryEndpoints;
+	SplineUpdateSnapshot.bIsValid = !IsClosedLoop();
+}
+
 void URoadSplineComponent::UpdateSpline(int EditingPointIndex)
 {
+	if (UpdateSplinePartial())
+	{
+		return;
+	}
+
 	//SetClosedLoop(false, false);
 	FixUpSegments();
 	UpdateAutoTangents(EditingPointIndex);
 	Super::UpdateSpline();
 	UpdateLaneSectionBounds();
+	UpdateSplineSnapshot();
 	/*
 	for (auto& Section : Sections)
 	{
@@ -763,12 +969,115 @@ void URoadSplineComponent::TrimLaneSections(double Tolerance)
 FPrimitiveSceneProxy* URoadSplineComponent::CreateSceneProxy()
 {
 #if WITH_EDITOR
-	return new FRoadSplineSceneProxy(this);
+	return new FRoadSplineSceneProxy(this, GetRoadMeshData());
 #else
 	return nullptr;
 #endif
 }
 
+#if WITH_EDITOR
+static TAutoConsoleVariable<bool> CVarAsyncRoadMeshBuild(
+	TEXT("UnrealDrive.AsyncRoadMeshBuild"), true,
+	TEXT("Build the lane meshes of the road spline scene proxies on the worker threads, the previous meshes are drawn meanwhile. [def: true]"));
+
+TSharedPtr<const UnrealDrive::FRoadMeshData> URoadSplineComponent::GetRoadMeshData()
+{
+	TSharedPtr<const UnrealDrive::FRoadMeshData> MeshData;
+	{
+		FScopeLock Lock(&RoadMeshDataLock);
+		MeshData = RoadMeshData;
+	}
+
+	if (MeshData && MeshData->IsUpToDate(this))
+	{
+		return MeshData;
+	}
+
+	if (!CVarAsyncRoadMeshBuild.GetValueOnAnyThread())
+	{
+		MeshData = UnrealDrive::FRoadMeshData::Build(this, MeshData.Get());
+		FScopeLock Lock(&RoadMeshDataLock);
+		RoadMeshData = MeshData;
+		return MeshData;
+	}
+
+	// The render state may be created on a worker thread
+	if (IsInGameThread())
+	{
+		StartRoadMeshBuild();
+	}
+	else
+	{
+		AsyncTask(ENamedThreads::GameThread, [WeakThis = TWeakObjectPtr<URoadSplineComponent>(this)]()
+		{
+			if (URoadSplineComponent* This = WeakThis.Get())
+			{
+				This->StartRoadMeshBuild();
+			}
+		});
+	}
+
+	return MeshData;
+}
+
+void URoadSplineComponent::StartRoadMeshBuild()
+{
+	check(IsInGameThread());
+
+	if (bRoadMeshBuildInFlight)
+	{
+		// The versions are checked again when the render state is recreated after the current build
+		return;
+	}
+	bRoadMeshBuildInFlight = true;
+
+	// The copy of the layout drops the lane connections, they aren't used by the mesh
+	URoadSplineComponent* Snapshot = NewObject<URoadSplineComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	Snapshot->SetClosedLoop(IsClosedLoop(), false);
+	Snapshot->SplineCurves = SplineCurves;
+	Snapshot->PointTypes = PointTypes;
+	Snapshot->ReparamStepsPerSegment = ReparamStepsPerSegment;
+	Snapshot->DefaultUpVector = DefaultUpVector;
+	Snapshot->RoadLayout = RoadLayout;
+	Snapshot->AddToRoot();
+
+	const uint64 SplineCurvesVersion = GetSplineCurvesVersion();
+	const uint64 LayoutVersion = RoadLayout.GetLayoutVersion();
+
+	// Unchanged section chunks of the previous mesh are reused
+	TSharedPtr<const UnrealDrive::FRoadMeshData> Previous;
+	{
+		FScopeLock Lock(&RoadMeshDataLock);
+		Previous = RoadMeshData;
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis = TWeakObjectPtr<URoadSplineComponent>(this), Snapshot, Previous, SplineCurvesVersion, LayoutVersion]()
+	{
+		TSharedRef<UnrealDrive::FRoadMeshData> MeshData = UnrealDrive::FRoadMeshData::Build(Snapshot, Previous.Get());
+		MeshData->SplineCurvesVersion = SplineCurvesVersion;
+		MeshData->LayoutVersion = LayoutVersion;
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Snapshot, MeshData = TSharedPtr<const UnrealDrive::FRoadMeshData>(MeshData)]()
+		{
+			Snapshot->RemoveFromRoot();
+			Snapshot->MarkAsGarbage();
+
+			if (URoadSplineComponent* This = WeakThis.Get())
+			{
+				{
+					FScopeLock Lock(&This->RoadMeshDataLock);
+					This->RoadMeshData = MeshData;
+				}
+				This->bRoadMeshBuildInFlight = false;
+
+				// Swap the proxy, it starts the next build if the road was changed meanwhile
+				This->MarkRenderStateDirty();
+			}
+		});
+	});
+}
+#endif
+
 void URoadSplineComponent::GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials) const
 {
 	TSet<TObjectPtr<UMaterialInterface>> UsedMaterials;
@@ -833,9 +1142,8 @@ void URoadSplineComponent::BuildOffsetCurves(double RightOffset, FSplineCurves&
 
 }
 
-void URoadSplineComponent::BuildLinearApproximation(TArray<FSplinePositionLinearApproximation>& OutPoints, const TFunction<double(double)>& RightOffsetFunc, double S0, double S1, int InReparamStepsPerSegment, int MinNumSteps, ESplineCoordinateSpace::Type CoordinateSpace) const
+void URoadSplineComponent::BuildLinearApproximation(TArray<FSplinePositionLinearApproximation>& OutPoints, const TFunction<double(double)>& RightOffsetFunc, double S0, double S1, int InReparamStepsPerSegment, int MinNumSteps, ESplineCoordinateSpace::Type CoordinateSpace, TArray<double>* OutSOffsets) const
 {
-	OutPoints.Reset();
 	const double SO_Param = GetInputKeyValueAtDistanceAlongSpline(S0);
 	const double S1_Param = GetInputKeyValueAtDistanceAlongSpline(S1);
 
@@ -843,11 +1151,22 @@ void URoadSplineComponent::BuildLinearApproximation(TArray<FSplinePositionLinear
 	if (NumStep < MinNumSteps) NumStep = MinNumSteps;
 	const double Step = (S1_Param - SO_Param) / NumStep;
 
+	OutPoints.Reset(NumStep + 1);
+	if (OutSOffsets)
+	{
+		OutSOffsets->Reset(NumStep + 1);
+	}
+
 	for (int i = 0; i <= NumStep; ++i)
 	{
 		const float Param = SO_Param + i * Step;
 		const FVector RightVector = GetRightVectorAtSplineInputKey(Param, ESplineCoordinateSpace::Local);
-		const double RightOffset = RightOffsetFunc(GetDistanceAlongSplineAtSplineInputKey(Param));
+		const double S = GetDistanceAlongSplineAtSplineInputKey(Param);
+		const double RightOffset = RightOffsetFunc(S);
+		if (OutSOffsets)
+		{
+			OutSOffsets->Add(S);
+		}
 		FVector Point = SplineCurves.Position.Eval(Param, FVector::ZeroVector) + RightVector * RightOffset;
 
 		if (CoordinateSpace == ESplineCoordinateSpace::World)
@@ -977,6 +1296,19 @@ int URoadSplineComponent::FindRoadSectionOnSplineKey(float SplineKey) const
 	return SectionIndex;
 }
 
+int URoadSplineComponent::FindRoadSectionOnSOffset(double SOffset) const
+{
+	const auto& Sections = GetLaneSections();
+	if (Sections.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// Sections are sorted by SOffset
+	const int SectionIndex = Algo::UpperBoundBy(Sections, SOffset, &FRoadLaneSection::SOffset) - 1;
+	return FMath::Clamp(SectionIndex, 0, Sections.Num() - 1);
+}
+
 int URoadSplineComponent::SplitSection(float SplineKey, ERoadLaneSectionSide Side)
 {
 	const int SectionIndex = FindRoadSectionOnSplineKey(SplineKey);
@@ -1176,11 +1508,25 @@ void URoadSplineComponent::PostEditChangeChainProperty(FPropertyChangedChainEven
 
 	GetRoadLayout().UpdateLayoutVersion();
 }
+
+void URoadSplineComponent::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	// The compiled curves and the layout caches aren't transacted, so they are rebuilt from the restored curves
+	GetRoadLayout().UpdateLayoutVersion();
+}
 #endif
 
 void URoadSplineComponent::UpdateMagicTransform(ERoadSplineMagicTransformFilter Filter)
 {
-	URoadConnection::GlobalTransformMagic = FMath::Rand();
+	// Monotonic magic, so TransformMagic left by a previous pass never matches the new one
+	static int32 TransformMagicCounter = 0;
+	if (++TransformMagicCounter == 0)
+	{
+		++TransformMagicCounter;
+	}
+	URoadConnection::GlobalTransformMagic = TransformMagicCounter;
 
 	TFunction<bool(const URoadSplineComponent*)> FilterFunc;
 
@@ -1210,11 +1556,36 @@ void URoadSplineComponent::UpdateMagicTransform(ERoadSplineMagicTransformFilter
 
 void URoadSplineComponent::MagicUpdateTransformInner(TFunction<bool(const URoadSplineComponent*)> Filter)
 {
-	Modify();
+	// Splines are expanded in breadth-first order. A spline is expanded again if its points are moved after it was expanded 
+	// (e.g. in roundabouts and junction loops), the pass is still bounded since each road connection is transformed at most once (see TransformMagic).
+	// Road connections reached from lane connections are moved without rebuilding their splines. The edited points are collected 
+	// and a spline is rebuilt once, right before its own lane connections are evaluated.
+
+	TArray<URoadSplineComponent*> Worklist;
+	TSet<URoadSplineComponent*> Enqueued; // Splines in the Worklist which aren't expanded yet
+	TMap<URoadSplineComponent*, TArray<int, TInlineAllocator<2>>> PendingPoints;
+
+	auto Enqueue = [&Worklist, &Enqueued](URoadSplineComponent* Spline)
+	{
+		bool bIsAlreadyInSet = false;
+		Enqueued.Add(Spline, &bIsAlreadyInSet);
+		if (!bIsAlreadyInSet)
+		{
+			Worklist.Add(Spline);
+		}
+	};
 
-	TArray<URoadSplineComponent*> SplinesToUpdate;
+	auto FlushPending = [&PendingPoints](URoadSplineComponent* Spline)
+	{
+		TArray<int, TInlineAllocator<2>> Points;
+		if (PendingPoints.RemoveAndCopyValue(Spline, Points))
+		{
+			Spline->UpdateSpline(Points);
+			Spline->MarkRenderStateDirty();
+		}
+	};
 
-	auto TransformRoadConnection = [&SplinesToUpdate, &Filter](URoadConnection * RoadConnection)
+	auto TransformRoadConnection = [&Enqueue, &Filter](URoadConnection * RoadConnection)
 	{
 		if (RoadConnection && RoadConnection->IsConnectionValid())
 		{
@@ -1227,7 +1598,7 @@ void URoadSplineComponent::MagicUpdateTransformInner(TFunction<bool(const URoadS
 					RoadConnection->TransformMagic = URoadConnection::GlobalTransformMagic;
 					if (bIsTransformed)
 					{
-						SplinesToUpdate.Add(RoadConnection->OuterLaneConnection->GetOwnedRoadSplineChecked());
+						Enqueue(RoadConnection->OuterLaneConnection->GetOwnedRoadSplineChecked());
 					}
 				}
 				else
@@ -1239,7 +1610,7 @@ void URoadSplineComponent::MagicUpdateTransformInner(TFunction<bool(const URoadS
 		}
 	};
 
-	auto TransformLaneConnection = [&SplinesToUpdate, &Filter](ULaneConnection * LaneConnection)
+	auto TransformLaneConnection = [&Enqueue, &PendingPoints, &Filter](ULaneConnection * LaneConnection)
 	{
 		if (LaneConnection && LaneConnection->IsConnectionValid())
 		{
@@ -1248,37 +1619,47 @@ void URoadSplineComponent::MagicUpdateTransformInner(TFunction<bool(const URoadS
 			{
 				if (RoadConnection.IsValid() && Filter(RoadConnection->GetOwnedRoadSpline()))
 				{
-					RoadConnection->GetOwnedRoadSpline()->Modify();
-					if (RoadConnection->SetTransform(Transform, true, ESplineCoordinateSpace::World))
+					URoadSplineComponent* OuterSpline = RoadConnection->GetOwnedRoadSplineChecked();
+					OuterSpline->Modify();
+					if (RoadConnection->SetTransform(Transform, false, ESplineCoordinateSpace::World))
 					{
-						SplinesToUpdate.Add(RoadConnection->GetOwnedRoadSplineChecked());
+						const int PointIndex = RoadConnection->IsPredecessorConnection() ? 0 : OuterSpline->GetNumberOfSplinePoints() - 1;
+						PendingPoints.FindOrAdd(OuterSpline).AddUnique(PointIndex);
+						Enqueue(OuterSpline);
 					}
 				}
 			}
 		}
 	};
 
-	TransformRoadConnection(GetPredecessorConnection());
-	TransformRoadConnection(GetSuccessorConnection());
-	
-	for (auto& Section : RoadLayout.Sections)
+	Modify();
+	Enqueue(this);
+
+	for (int WorkIndex = 0; WorkIndex < Worklist.Num(); ++WorkIndex)
 	{
-		for (auto& Lane : Section.Left)
-		{
-			TransformLaneConnection(Lane.PredecessorConnection);
-			TransformLaneConnection(Lane.SuccessorConnection);
-		}
-		for (auto& Lane : Section.Right)
+		URoadSplineComponent* Spline = Worklist[WorkIndex];
+		Enqueued.Remove(Spline);
+		FlushPending(Spline);
+
+		TransformRoadConnection(Spline->GetPredecessorConnection());
+		TransformRoadConnection(Spline->GetSuccessorConnection());
+
+		for (auto& Section : Spline->RoadLayout.Sections)
 		{
-			TransformLaneConnection(Lane.PredecessorConnection);
-			TransformLaneConnection(Lane.SuccessorConnection);
+			for (auto& Lane : Section.Left)
+			{
+				TransformLaneConnection(Lane.PredecessorConnection);
+				TransformLaneConnection(Lane.SuccessorConnection);
+			}
+			for (auto& Lane : Section.Right)
+			{
+				TransformLaneConnection(Lane.PredecessorConnection);
+				TransformLaneConnection(Lane.SuccessorConnection);
+			}
 		}
 	}
 
-	for (auto& It : SplinesToUpdate)
-	{
-		It->MagicUpdateTransformInner(Filter);
-	}
+	check(PendingPoints.Num() == 0);
 }
 
 
@@ -1515,10 +1896,38 @@ void URoadSplineComponent::OnRegister()
 
 	GetPredecessorConnection()->InitConnection();
 	GetSuccessorConnection()->InitConnection();
+
+	if (UWorld* World = GetWorld())
+	{
+		if (URoadLaneIndexSubsystem* LaneIndex = World->GetSubsystem<URoadLaneIndexSubsystem>())
+		{
+			LaneIndex->RegisterRoadSpline(this);
+		}
+#if WITH_EDITOR
+		if (UUnrealDriveSubsystem* Subsystem = World->GetSubsystem<UUnrealDriveSubsystem>())
+		{
+			Subsystem->RegisterRoadSpline(this);
+		}
+#endif
+	}
 }
 
 void URoadSplineComponent::OnUnregister()
 {
+	if (UWorld* World = GetWorld())
+	{
+		if (URoadLaneIndexSubsystem* LaneIndex = World->GetSubsystem<URoadLaneIndexSubsystem>())
+		{
+			LaneIndex->UnregisterRoadSpline(this);
+		}
+#if WITH_EDITOR
+		if (UUnrealDriveSubsystem* Subsystem = World->GetSubsystem<UUnrealDriveSubsystem>())
+		{
+			Subsystem->UnregisterRoadSpline(this);
+		}
+#endif
+	}
+
 	Super::OnUnregister();
 }
 
@@ -1615,6 +2024,87 @@ FRoadPosition URoadSplineComponent::GetRoadPosition(int SectionIndex, int LaneIn
 	return GetRoadPosition(SOffset, ROffset, CoordinateSpace);
 }
 
+namespace RoadPositionBatch
+{
+	static constexpr int BatchSize = 256;
+}
+
+void URoadSplineComponent::GetRoadPositionsInner(int NumQueries, TFunctionRef<double(int QueryIndex)> GetSOffset, TFunctionRef<double(int QueryIndex, double SOffset)> GetROffset, TArrayView<FRoadPosition> OutPositions, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	check(OutPositions.Num() == NumQueries);
+
+	if (NumQueries == 0)
+	{
+		return;
+	}
+
+	// Ascending SOffset order, the sorting is skipped if the queries are already sorted (e.g. sampling along the road)
+	TArray<int> Order;
+	Order.SetNumUninitialized(NumQueries);
+	bool bIsSorted = true;
+	for (int i = 0; i < NumQueries; ++i)
+	{
+		Order[i] = i;
+		bIsSorted &= (i == 0 || GetSOffset(i - 1) <= GetSOffset(i));
+	}
+	if (!bIsSorted)
+	{
+		TArray<double> Keys;
+		Keys.SetNumUninitialized(NumQueries);
+		for (int i = 0; i < NumQueries; ++i)
+		{
+			Keys[i] = GetSOffset(i);
+		}
+		Algo::StableSort(Order, [&Keys](int A, int B) { return Keys[A] < Keys[B]; });
+	}
+
+	const int NumBatches = FMath::DivideAndRoundUp(NumQueries, RoadPositionBatch::BatchSize);
+	ParallelFor(NumBatches, [&](int BatchIndex)
+	{
+		int ReparamHint = 0;
+		const int First = BatchIndex * RoadPositionBatch::BatchSize;
+		const int Last = FMath::Min(First + RoadPositionBatch::BatchSize, NumQueries);
+		for (int i = First; i < Last; ++i)
+		{
+			const int QueryIndex = Order[i];
+			const double SOffset = GetSOffset(QueryIndex);
+			const double ROffset = GetROffset(QueryIndex, SOffset);
+			const float Param = UnrealDrive::EvalReparamTable(SplineCurves.ReparamTable, SOffset, ReparamHint);
+
+			// The same as GetRightVectorAtSplineInputKey(), but without the second evaluation of the quaternion
+			const FQuat Quat = GetQuaternionAtSplineInputKey(Param, CoordinateSpace);
+
+			FRoadPosition& Pos = OutPositions[QueryIndex];
+			Pos.Location = GetLocationAtSplineInputKey(Param, CoordinateSpace) + Quat.GetRightVector() * ROffset;
+			Pos.Quat = Quat;
+			Pos.SOffset = SOffset;
+			Pos.ROffset = ROffset;
+		}
+	}, NumBatches == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void URoadSplineComponent::GetRoadPositions(TConstArrayView<FRoadLanePositionQuery> Queries, TArrayView<FRoadPosition> OutPositions, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	GetRoadPositionsInner(Queries.Num(),
+		[&Queries](int QueryIndex) { return Queries[QueryIndex].SOffset; },
+		[this, &Queries](int QueryIndex, double SOffset)
+		{
+			const FRoadLanePositionQuery& Query = Queries[QueryIndex];
+			return RoadLayout.Sections[Query.SectionIndex].EvalLaneROffset(Query.LaneIndex, SOffset, Query.Alpha) + EvalROffset(SOffset);
+		},
+		OutPositions, CoordinateSpace);
+}
+
+void URoadSplineComponent::GetRoadPositions(TConstArrayView<double> SOffsets, TConstArrayView<double> ROffsets, TArrayView<FRoadPosition> OutPositions, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	check(SOffsets.Num() == ROffsets.Num());
+
+	GetRoadPositionsInner(SOffsets.Num(),
+		[&SOffsets](int QueryIndex) { return SOffsets[QueryIndex]; },
+		[&ROffsets](int QueryIndex, double SOffset) { return ROffsets[QueryIndex]; },
+		OutPositions, CoordinateSpace);
+}
+
 const FRoadLane* URoadSplineComponent::GetRoadLane(int SectionIndex, int LaneIndex) const
 {
 	if (SectionIndex >= 0 && SectionIndex < GetLaneSectionsNum())
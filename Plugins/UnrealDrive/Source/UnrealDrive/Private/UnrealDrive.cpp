@@ -5,6 +5,11 @@
 
 #include "UnrealDrive.h"
 #include "UnrealDriveVersion.h"
+#include "RoadSceneProxy.h"
+
+#if WITH_EDITOR
+#include "Materials/Material.h"
+#endif
 
 #define LOCTEXT_NAMESPACE "FUnrealDriveModule"
 
@@ -13,10 +18,21 @@ bool FUnrealDriveModule::bIsRoadSplinesVisibleInEditor = true;
 void FUnrealDriveModule::StartupModule()
 {
 	UE_LOG(LogUnrealDrive, Log, TEXT("UnreadDrive version: " UNREALDRIVE_VERSION_STRING));
+
+#if WITH_EDITOR
+	MaterialCompilationFinishedHandle = UMaterial::OnMaterialCompilationFinished().AddLambda([](UMaterialInterface*)
+	{
+		UnrealDrive::ResetMaterialRelevanceCache();
+	});
+#endif
 }
 
 void FUnrealDriveModule::ShutdownModule()
 {
+#if WITH_EDITOR
+	UMaterial::OnMaterialCompilationFinished().Remove(MaterialCompilationFinishedHandle);
+#endif
+	UnrealDrive::ResetMaterialRelevanceCache();
 }
 
 #undef LOCTEXT_NAMESPACE
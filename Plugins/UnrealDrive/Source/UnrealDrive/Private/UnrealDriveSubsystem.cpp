@@ -8,11 +8,48 @@
 #include "EngineUtils.h"
 #include "UnrealDrive.h"
 #include "SceneView.h"
+#include "SceneManagement.h"
 
 #if WITH_EDITOR
 
 #include "Selection.h"
 
+namespace UnrealDriveSubsystem
+{
+	// Radius of the connection gizmo used for the frustum culling in ForEachObservedConnection() [cm]
+	static constexpr double CullRadius = 300.0;
+
+	/** The proxies of the road splines depend on the number of the road splines of the actor, see FRoadSplineSceneProxy */
+	static void MarkRoadSplinesRenderStateDirty(AActor* Actor, const URoadSplineComponent* ExceptRoadSpline)
+	{
+		Actor->ForEachComponent<URoadSplineComponent>(false, [ExceptRoadSpline](URoadSplineComponent* RoadSpline)
+		{
+			if (RoadSpline != ExceptRoadSpline)
+			{
+				RoadSpline->MarkRenderStateDirty();
+			}
+		});
+	}
+
+	/** Visit the predecessor and successor lane connections of all lanes of the RoadSpline */
+	static void ForEachLaneConnection(const URoadSplineComponent* RoadSpline, TFunctionRef<void(const ULaneConnection*)> Func)
+	{
+		for (auto& Section : RoadSpline->GetLaneSections())
+		{
+			for (auto& Lane : Section.Left)
+			{
+				if (Lane.PredecessorConnection) Func(Lane.PredecessorConnection);
+				if (Lane.SuccessorConnection) Func(Lane.SuccessorConnection);
+			}
+			for (auto& Lane : Section.Right)
+			{
+				if (Lane.PredecessorConnection) Func(Lane.PredecessorConnection);
+				if (Lane.SuccessorConnection) Func(Lane.SuccessorConnection);
+			}
+		}
+	}
+}
+
 void UUnrealDriveSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	if (GetWorld()->WorldType == EWorldType::Editor)
@@ -20,16 +57,13 @@ void UUnrealDriveSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		GEngine->OnLevelActorAdded().AddUObject(this, &UUnrealDriveSubsystem::OnActorSpawned);
 		GEngine->OnLevelActorDeleted().AddUObject(this, &UUnrealDriveSubsystem::OnActorDeleted, true);
 
-		//FEditorDelegates::OnEditCutActorsBegin.AddRaw(this, &UUnrealDriveSubsystem::OnEditCutActorsBegin);
-		//FEditorDelegates::OnEditCutActorsEnd.AddRaw(this, &UUnrealDriveSubsystem::OnEditCutActorsEnd);
-		// 
-		//FEditorDelegates::OnEditCopyActorsBegin.AddRaw(this, &UUnrealDriveSubsystem::OnEditCopyActorsBegin);
-		//FEditorDelegates::OnEditCopyActorsEnd.AddRaw(this, &UUnrealDriveSubsystem::OnEditCopyActorsEnd);
+		FEditorDelegates::OnEditCutActorsBegin.AddUObject(this, &UUnrealDriveSubsystem::OnCopyActorsBegin);
+		FEditorDelegates::OnEditCopyActorsBegin.AddUObject(this, &UUnrealDriveSubsystem::OnCopyActorsBegin);
 
 		FEditorDelegates::OnDuplicateActorsBegin.AddUObject(this, &UUnrealDriveSubsystem::OnDuplicateActorsBegin);
 		FEditorDelegates::OnDuplicateActorsEnd.AddUObject(this, &UUnrealDriveSubsystem::OnDuplicateActorsEnd);
 
-		FEditorDelegates::OnEditPasteActorsBegin.AddUObject(this, &UUnrealDriveSubsystem::OnDuplicateActorsBegin);
+		FEditorDelegates::OnEditPasteActorsBegin.AddUObject(this, &UUnrealDriveSubsystem::OnPasteActorsBegin);
 		FEditorDelegates::OnEditPasteActorsEnd.AddUObject(this, &UUnrealDriveSubsystem::OnDuplicateActorsEnd);
 	}
 
@@ -47,6 +81,9 @@ void UUnrealDriveSubsystem::Deinitialize()
 		GEngine->OnLevelActorAdded().RemoveAll(this);
 		GEngine->OnLevelActorDeleted().RemoveAll(this);
 
+		FEditorDelegates::OnEditCutActorsBegin.RemoveAll(this);
+		FEditorDelegates::OnEditCopyActorsBegin.RemoveAll(this);
+
 		FEditorDelegates::OnDuplicateActorsBegin.RemoveAll(this);
 		FEditorDelegates::OnDuplicateActorsEnd.RemoveAll(this);
 
@@ -56,6 +93,10 @@ void UUnrealDriveSubsystem::Deinitialize()
 
 	bRoadSplineWasSelected = false;
 
+	ConnectionsEntries.Empty();
+	ConnectionsEntryIndices.Empty();
+	ConnectionsBVH.Reset();
+	bConnectionsBVHDirty = true;
 }
 
 void UUnrealDriveSubsystem::Tick(float DeltaSeconds)
@@ -92,103 +133,129 @@ void UUnrealDriveSubsystem::OnActorDeleted(AActor* InActor, bool bClearStencilId
 {
 }
 
-void UUnrealDriveSubsystem::OnDuplicateActorsBegin()
+void UUnrealDriveSubsystem::GetSelectedRoadSplines(TArray<URoadSplineComponent*>& OutRoadSplines)
 {
-	bDuplicationStarted = true;
-
-	// Generate of new GUID for all ULaneConnection on the level
-	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	for (FSelectionIterator It = GEditor->GetSelectedActorIterator(); It; ++It)
 	{
-		It->ForEachComponent<URoadSplineComponent>(true, [&](const URoadSplineComponent* Comp)
+		if (AActor* Actor = Cast<AActor>(*It))
 		{
-			for (auto& Section : Comp->GetLaneSections())
+			Actor->ForEachComponent<URoadSplineComponent>(true, [&](URoadSplineComponent* Comp)
 			{
-				for (auto& Lane : Section.Left)
-				{
-					Lane.PredecessorConnection->Guid = FGuid::NewGuid();
-					Lane.SuccessorConnection->Guid = FGuid::NewGuid();
-				}
-				for (auto& Lane : Section.Right)
-				{
-					Lane.PredecessorConnection->Guid = FGuid::NewGuid();
-					Lane.SuccessorConnection->Guid = FGuid::NewGuid();
-				}
-			}
-		});
+				OutRoadSplines.Add(Comp);
+			});
+		}
 	}
+}
 
-	// Set LaneConnectionGuid for all connected URoadConnection on the level
-	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+void UUnrealDriveSubsystem::AssignConnectionGuids(TConstArrayView<URoadSplineComponent*> RoadSplines)
+{
+	// Generate of new GUID for all ULaneConnection of the roads
+	for (const URoadSplineComponent* Comp : RoadSplines)
 	{
-		It->ForEachComponent<URoadSplineComponent>(true, [&](const URoadSplineComponent* Comp)
+		for (auto& Section : Comp->GetLaneSections())
 		{
-			if(Comp->GetPredecessorConnection()->IsConnected())
+			for (auto& Lane : Section.Left)
 			{
-				Comp->GetPredecessorConnection()->LaneConnectionGuid = Comp->GetPredecessorConnection()->GetOuterConnection()->Guid;
+				Lane.PredecessorConnection->Guid = FGuid::NewGuid();
+				Lane.SuccessorConnection->Guid = FGuid::NewGuid();
 			}
-			else
+			for (auto& Lane : Section.Right)
 			{
-				Comp->GetPredecessorConnection()->LaneConnectionGuid = FGuid{};
+				Lane.PredecessorConnection->Guid = FGuid::NewGuid();
+				Lane.SuccessorConnection->Guid = FGuid::NewGuid();
 			}
+		}
+	}
 
-			if (Comp->GetSuccessorConnection()->IsConnected())
-			{
-				Comp->GetSuccessorConnection()->LaneConnectionGuid = Comp->GetSuccessorConnection()->GetOuterConnection()->Guid;
-			}
-			else
-			{
-				Comp->GetSuccessorConnection()->LaneConnectionGuid = FGuid{};
-			}
-		});
+	// Set LaneConnectionGuid for all connected URoadConnection of the roads. 
+	// The connections to the lanes outside of RoadSplines keep the old GUID of the lane, so they are never matched with the new GUIDs
+	for (const URoadSplineComponent* Comp : RoadSplines)
+	{
+		for (URoadConnection* RoadConnection : { Comp->GetPredecessorConnection(), Comp->GetSuccessorConnection() })
+		{
+			RoadConnection->LaneConnectionGuid = RoadConnection->IsConnected() ? RoadConnection->GetOuterConnection()->Guid : FGuid{};
+		}
 	}
 }
 
-void UUnrealDriveSubsystem::OnDuplicateActorsEnd()
+void UUnrealDriveSubsystem::OnCopyActorsBegin()
 {
-	bDuplicationStarted = false;
+	// The GUIDs are exported with the actors and used to restore the connections on paste
+	TArray<URoadSplineComponent*> RoadSplines;
+	GetSelectedRoadSplines(RoadSplines);
+	AssignConnectionGuids(RoadSplines);
+}
 
+void UUnrealDriveSubsystem::OnPasteActorsBegin()
+{
+	// The pasted actors already have the GUIDs assigned in OnCopyActorsBegin()
+	bDuplicationStarted = true;
+}
 
-	TMap<FGuid, ULaneConnection*> Links;
+void UUnrealDriveSubsystem::OnDuplicateActorsBegin()
+{
+	bDuplicationStarted = true;
+
+	// Only the selected actors are duplicated, so only their connections need the new GUIDs
+	TArray<URoadSplineComponent*> RoadSplines;
+	GetSelectedRoadSplines(RoadSplines);
+	AssignConnectionGuids(RoadSplines);
+}
+
+void UUnrealDriveSubsystem::OnDuplicateActorsEnd()
+{
+	bDuplicationStarted = false;
 
+	TArray<URoadSplineComponent*> RoadSplines;
+	int NumLaneConnections = 0;
 	for (auto& DupicatedActor : DuplicatedActors)
 	{
-		DupicatedActor->ForEachComponent<URoadSplineComponent>(true, [&](const URoadSplineComponent* Comp)
+		if (IsValid(DupicatedActor))
 		{
-			for (auto& Section : Comp->GetLaneSections())
+			DupicatedActor->ForEachComponent<URoadSplineComponent>(true, [&](URoadSplineComponent* Comp)
 			{
-				for (auto& Lane : Section.Left)
+				RoadSplines.Add(Comp);
+				for (auto& Section : Comp->GetLaneSections())
 				{
-					Links.Add(Lane.PredecessorConnection->Guid, Lane.PredecessorConnection);
-					Links.Add(Lane.SuccessorConnection->Guid, Lane.SuccessorConnection);
+					NumLaneConnections += (Section.Left.Num() + Section.Right.Num()) * 2;
 				}
-				for (auto& Lane : Section.Right)
-				{
-					Links.Add(Lane.PredecessorConnection->Guid, Lane.PredecessorConnection);
-					Links.Add(Lane.SuccessorConnection->Guid, Lane.SuccessorConnection);
-				}
-			}
-		});
+			});
+		}
 	}
 
-	for (auto& DupicatedActor : DuplicatedActors)
+	// Old GUID -> new lane connection, built once for the whole transaction
+	TMap<FGuid, ULaneConnection*> Links;
+	Links.Reserve(NumLaneConnections);
+
+	for (const URoadSplineComponent* Comp : RoadSplines)
 	{
-		DupicatedActor->ForEachComponent<URoadSplineComponent>(true, [&](const URoadSplineComponent* Comp)
+		for (auto& Section : Comp->GetLaneSections())
 		{
-			if(Comp->GetPredecessorConnection()->LaneConnectionGuid.IsValid())
+			for (auto& Lane : Section.Left)
 			{
-				if (auto* Conn = Links.Find(Comp->GetPredecessorConnection()->LaneConnectionGuid))
-				{
-					Comp->GetPredecessorConnection()->ConnectTo(*Conn);
-				}
+				Links.Add(Lane.PredecessorConnection->Guid, Lane.PredecessorConnection);
+				Links.Add(Lane.SuccessorConnection->Guid, Lane.SuccessorConnection);
+			}
+			for (auto& Lane : Section.Right)
+			{
+				Links.Add(Lane.PredecessorConnection->Guid, Lane.PredecessorConnection);
+				Links.Add(Lane.SuccessorConnection->Guid, Lane.SuccessorConnection);
 			}
-			if (Comp->GetSuccessorConnection()->LaneConnectionGuid.IsValid())
+		}
+	}
+
+	for (const URoadSplineComponent* Comp : RoadSplines)
+	{
+		for (URoadConnection* RoadConnection : { Comp->GetPredecessorConnection(), Comp->GetSuccessorConnection() })
+		{
+			if (RoadConnection->LaneConnectionGuid.IsValid())
 			{
-				if (auto* Conn = Links.Find(Comp->GetSuccessorConnection()->LaneConnectionGuid))
+				if (auto* Conn = Links.Find(RoadConnection->LaneConnectionGuid))
 				{
-					Comp->GetSuccessorConnection()->ConnectTo(*Conn);
+					RoadConnection->ConnectTo(*Conn);
 				}
 			}
-		});
+		}
 	}
 
 	DuplicatedActors.Empty();
@@ -204,85 +271,228 @@ void UUnrealDriveSubsystem::EndCopyRoadTransaction()
 
 void UUnrealDriveSubsystem::UpdateObservedConnections(const URoadSplineComponent* RoadSpline)
 {
-	auto* Connections =  ObservedConnections.Find(RoadSpline);
-	if (!Connections)
+	if (ObservedConnections.Num() == 0)
 	{
 		return;
 	}
 
-	auto UpdateConnection = [Connections](ULaneConnection* ProbeConnection)
+	UnrealDriveSubsystem::ForEachLaneConnection(RoadSpline, [this, RoadSpline](const ULaneConnection* Connection)
 	{
-		if (auto* Info = Connections->Find(ProbeConnection))
+		if (const int* ObservedIndex = ObservedConnectionIndices.Find(Connection))
 		{
-			Info->Transform = ProbeConnection->EvalTransform(0.5, ESplineCoordinateSpace::World);
+			FObservedConnection& Observed = ObservedConnections[*ObservedIndex];
+			if (Observed.RoadSpline.Get() == RoadSpline)
+			{
+				Observed.Info.Transform = Connection->EvalTransform(0.5, ESplineCoordinateSpace::World);
+			}
 		}
-	};
+	});
+}
+
+void UUnrealDriveSubsystem::CleanObservedConnections() 
+{ 
+	ObservedConnections.Empty();
+	ObservedConnectionIndices.Empty();
+}
+
+void UUnrealDriveSubsystem::AddObservedConnection(const URoadSplineComponent* RoadSpline, const ULaneConnection* Connection, const FConnectionInfo& Info)
+{
+	ObservedConnectionIndices.Add(Connection, ObservedConnections.Add({ RoadSpline, Connection, Info }));
+}
+
 
-	for (auto& Section : RoadSpline->GetLaneSections())
+void UUnrealDriveSubsystem::AddObservedConnections(const URoadSplineComponent* RoadSpline, const TArray<const ULaneConnection*>& Connections)
+{
+	for (auto& Connection : Connections)
 	{
-		for (auto& Lane : Section.Left)
+		const FConnectionInfo Info{ Connection->EvalTransform(0.5, ESplineCoordinateSpace::World), false };
+		if (const int* ObservedIndex = ObservedConnectionIndices.Find(Connection))
 		{
-			UpdateConnection(Lane.PredecessorConnection);
-			UpdateConnection(Lane.SuccessorConnection);
+			ObservedConnections[*ObservedIndex].Info = Info;
 		}
-		for (auto& Lane : Section.Right)
+		else
 		{
-			UpdateConnection(Lane.PredecessorConnection);
-			UpdateConnection(Lane.SuccessorConnection);
+			AddObservedConnection(RoadSpline, Connection, Info);
 		}
 	}
 }
 
-void UUnrealDriveSubsystem::CleanObservedConnections() 
-{ 
-	ObservedConnections.Empty();
+void UUnrealDriveSubsystem::RegisterRoadSpline(const URoadSplineComponent* RoadSpline)
+{
+	check(IsInGameThread());
+
+	if (!RoadSpline)
+	{
+		return;
+	}
+
+	const int* FoundIndex = ConnectionsEntryIndices.Find(RoadSpline);
+	int EntryIndex = FoundIndex ? *FoundIndex : INDEX_NONE;
+	if (EntryIndex == INDEX_NONE)
+	{
+		EntryIndex = ConnectionsEntries.AddDefaulted();
+		ConnectionsEntries[EntryIndex].RoadSpline = RoadSpline;
+		ConnectionsEntryIndices.Add(RoadSpline, EntryIndex);
+
+		if (AActor* Owner = RoadSpline->GetOwner())
+		{
+			int& NumRoadSplines = NumActorRoadSplines.FindOrAdd(Owner);
+			if (++NumRoadSplines == 2)
+			{
+				UnrealDriveSubsystem::MarkRoadSplinesRenderStateDirty(Owner, RoadSpline);
+			}
+		}
+	}
+
+	// The entry of a destroyed spline at the same address is reused too
+	FConnectionsEntry& Entry = ConnectionsEntries[EntryIndex];
+	Entry.WeakRoadSpline = RoadSpline;
+	Entry.bIsDirty = true;
 }
 
+void UUnrealDriveSubsystem::UnregisterRoadSpline(const URoadSplineComponent* RoadSpline)
+{
+	check(IsInGameThread());
 
-void UUnrealDriveSubsystem::AddObservedConnections(const URoadSplineComponent* RoadSpline, const TArray<const ULaneConnection*>& Connections)
+	if (const int* EntryIndex = ConnectionsEntryIndices.Find(RoadSpline))
+	{
+		RemoveConnectionsEntryAtSwap(*EntryIndex);
+
+		if (AActor* Owner = RoadSpline->GetOwner())
+		{
+			if (int* NumRoadSplines = NumActorRoadSplines.Find(Owner))
+			{
+				if (--(*NumRoadSplines) <= 0)
+				{
+					NumActorRoadSplines.Remove(Owner);
+				}
+				else if (*NumRoadSplines == 1)
+				{
+					UnrealDriveSubsystem::MarkRoadSplinesRenderStateDirty(Owner, RoadSpline);
+				}
+			}
+		}
+	}
+}
+
+void UUnrealDriveSubsystem::RemoveConnectionsEntryAtSwap(int EntryIndex)
 {
-	auto& ConnectionsMap = ObservedConnections.FindOrAdd(RoadSpline);
-	for (auto& Connection : Connections)
+	ConnectionsEntryIndices.Remove(ConnectionsEntries[EntryIndex].RoadSpline);
+	ConnectionsEntries.RemoveAtSwap(EntryIndex);
+	if (EntryIndex < ConnectionsEntries.Num())
+	{
+		ConnectionsEntryIndices[ConnectionsEntries[EntryIndex].RoadSpline] = EntryIndex;
+	}
+	bConnectionsBVHDirty = true;
+}
+
+void UUnrealDriveSubsystem::BuildConnectionsEntry(const URoadSplineComponent* RoadSpline, FConnectionsEntry& Entry) const
+{
+	Entry.Connections.Reset();
+	Entry.Bounds = FBox(ForceInit);
+
+	UnrealDriveSubsystem::ForEachLaneConnection(RoadSpline, [&Entry](const ULaneConnection* Connection)
+	{
+		const FTransform Transform = Connection->EvalTransform(0.5, ESplineCoordinateSpace::World);
+		Entry.Connections.Add({ Connection, Transform });
+		Entry.Bounds += Transform.GetLocation();
+	});
+}
+
+void UUnrealDriveSubsystem::UpdateConnectionsIndex()
+{
+	check(IsInGameThread());
+
+	for (int EntryIndex = ConnectionsEntries.Num() - 1; EntryIndex >= 0; --EntryIndex)
+	{
+		FConnectionsEntry& Entry = ConnectionsEntries[EntryIndex];
+		const URoadSplineComponent* RoadSpline = Entry.WeakRoadSpline.Get();
+		if (!RoadSpline)
+		{
+			RemoveConnectionsEntryAtSwap(EntryIndex);
+			continue;
+		}
+
+		const uint64 SplineCurvesVersion = RoadSpline->GetSplineCurvesVersion();
+		const uint64 LayoutVersion = RoadSpline->GetRoadLayout().GetLayoutVersion();
+		const FTransform& Transform = RoadSpline->GetComponentTransform();
+
+		if (Entry.bIsDirty ||
+			Entry.SplineCurvesVersion != SplineCurvesVersion ||
+			Entry.LayoutVersion != LayoutVersion ||
+			!Entry.Transform.Equals(Transform, 0.0))
+		{
+			BuildConnectionsEntry(RoadSpline, Entry);
+			Entry.SplineCurvesVersion = SplineCurvesVersion;
+			Entry.LayoutVersion = LayoutVersion;
+			Entry.Transform = Transform;
+			Entry.bIsDirty = false;
+			bConnectionsBVHDirty = true;
+		}
+	}
+
+	if (bConnectionsBVHDirty)
 	{
-		ConnectionsMap.FindOrAdd(Connection) = { Connection->EvalTransform(0.5, ESplineCoordinateSpace::World), false };
+		TArray<FBox> EntryBounds;
+		EntryBounds.Reserve(ConnectionsEntries.Num());
+		for (const FConnectionsEntry& Entry : ConnectionsEntries)
+		{
+			EntryBounds.Add(Entry.Bounds);
+		}
+		ConnectionsBVH.Build(EntryBounds);
+		bConnectionsBVHDirty = false;
 	}
 }
 
 void UUnrealDriveSubsystem::CaptureConnections(const URoadConnection* SrcConnection, const FViewCameraState& CameraState, double MaxViewDistance, double MaxOrthoWidth, TFunction<bool(const ULaneConnection*)> IsConnectionAllowed)
 {
-	ObservedConnections.Empty();
+	CleanObservedConnections();
 
 	if (CameraState.bIsOrthographic && CameraState.OrthoWorldCoordinateWidth > MaxOrthoWidth)
 	{
 		return;
 	}
 
-	int NumCaptured = 0;
+	UpdateConnectionsIndex();
+
+	FConvexVolume ViewFrustum;
+	GetViewFrustumBounds(ViewFrustum, CameraState.ViewToProj, false);
 
-	auto TryAddConnection = [&](ULaneConnection* ProbeConnection, TMap<TWeakObjectPtr<const ULaneConnection>, FConnectionInfo> & Connections)
+	const double MaxViewDistanceSquared = FMath::Square(MaxViewDistance);
+	auto IsBoxVisible = [&](const FBox& Box)
 	{
-		check(ProbeConnection);
-		if (!IsConnectionAllowed(ProbeConnection))
+		if (!Box.IsValid)
 		{
 			return false;
 		}
+		if (!CameraState.bIsOrthographic && Box.ComputeSquaredDistanceToPoint(CameraState.ViewPosition) > MaxViewDistanceSquared)
+		{
+			return false;
+		}
+		return ViewFrustum.IntersectBox(Box.GetCenter(), Box.GetExtent());
+	};
+
+	int NumCaptured = 0;
 
-		if (!SrcConnection->CanConnectTo(ProbeConnection))
+	auto TryAddConnection = [&](const URoadSplineComponent* Comp, const FIndexedConnection& Probe)
+	{
+		const ULaneConnection* Connection = Probe.Connection.Get();
+		if (!IsValid(Connection) || !IsValid(Connection->GetOwnedRoadSpline()))
 		{
 			return false;
 		}
 
-		FTransform Transform = ProbeConnection->EvalTransform(0.5, ESplineCoordinateSpace::World);
+		const FVector Location = Probe.Transform.GetLocation();
 		if (!CameraState.bIsOrthographic)
 		{
-			if ((Transform.GetLocation() - CameraState.ViewPosition).Length() > MaxViewDistance)
+			if ((Location - CameraState.ViewPosition).Length() > MaxViewDistance)
 			{
 				return false;
 			}
 		}
 
 		FVector2D ScreenPos;
-		if (!FSceneView::ProjectWorldToScreen(Transform.GetLocation(), CameraState.ViewRect, CameraState.ViewToProj, ScreenPos))
+		if (!FSceneView::ProjectWorldToScreen(Location, CameraState.ViewRect, CameraState.ViewToProj, ScreenPos))
 		{
 			return false;
 		}
@@ -291,74 +501,77 @@ void UUnrealDriveSubsystem::CaptureConnections(const URoadConnection* SrcConnect
 		{
 			return false;
 		}
-		
-		Connections.Emplace(ProbeConnection, { Transform, false });
+
+		if (!IsConnectionAllowed(Connection))
+		{
+			return false;
+		}
+
+		if (!SrcConnection->CanConnectTo(Connection))
+		{
+			return false;
+		}
+
+		AddObservedConnection(Comp, Connection, { Probe.Transform, false });
 		++NumCaptured;
 		return true;
 	};
 
-
-	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	ConnectionsBVH.QueryByPredicate(IsBoxVisible, [&](int EntryIndex)
 	{
-		It->ForEachComponent<URoadSplineComponent>(true, [&](const URoadSplineComponent* Comp)
+		const FConnectionsEntry& Entry = ConnectionsEntries[EntryIndex];
+		const URoadSplineComponent* Comp = Entry.WeakRoadSpline.Get();
+		if (!Comp)
 		{
-			TMap<TWeakObjectPtr<const ULaneConnection>, FConnectionInfo> Connections;
-			for (auto& Section : Comp->GetLaneSections())
-			{
-				for (auto& Lane : Section.Left)
-				{
-					TryAddConnection(Lane.PredecessorConnection, Connections);
-					TryAddConnection(Lane.SuccessorConnection, Connections);
-				}
-				for (auto& Lane : Section.Right)
-				{
-					TryAddConnection(Lane.PredecessorConnection, Connections);
-					TryAddConnection(Lane.SuccessorConnection, Connections);
-				}
-			}
-			if (Connections.Num())
-			{
-				ObservedConnections.Add(Comp, MoveTemp(Connections));
-			}
-		});
-	}
+			return true;
+		}
+
+		for (const FIndexedConnection& Probe : Entry.Connections)
+		{
+			TryAddConnection(Comp, Probe);
+		}
+		return true;
+	});
 
 	UE_LOG(LogUnrealDrive, Log, TEXT("Captured %i connections"), NumCaptured);
 }
 
 
-void UUnrealDriveSubsystem::ForEachObservedConnection(TFunctionRef<void(const ULaneConnection*, FConnectionInfo&)> VisitorFunc)
+void UUnrealDriveSubsystem::ForEachObservedConnection(TFunctionRef<void(const ULaneConnection*, FConnectionInfo&)> VisitorFunc, const FConvexVolume* ViewFrustum, const URoadSplineComponent* RoadSpline)
 {
-	for (auto& [Spline, Connections] : ObservedConnections)
+	for (FObservedConnection& Observed : ObservedConnections)
 	{
-		for (auto& [Connection, Info] : Connections)
+		if (RoadSpline && Observed.RoadSpline.Get() != RoadSpline)
+		{
+			continue;
+		}
+
+		if (ViewFrustum && !ViewFrustum->IntersectSphere(Observed.Info.Transform.GetLocation(), UnrealDriveSubsystem::CullRadius))
+		{
+			continue;
+		}
+
+		if (auto* Ptr = Observed.Connection.Get())
 		{
-			if (auto* Ptr = Connection.Get())
+			if (IsValid(Ptr) && IsValid(Ptr->GetOwnedRoadSpline()))
 			{
-				if (IsValid(Ptr) && IsValid(Ptr->GetOwnedRoadSpline()))
-				{
-					VisitorFunc(Ptr, Info);
-				}
+				VisitorFunc(Ptr, Observed.Info);
 			}
 		}
 	}
 }
 
-TPair<TWeakObjectPtr<const ULaneConnection>, UUnrealDriveSubsystem::FConnectionInfo>* UUnrealDriveSubsystem::FindObservedConnectionByPredicate(TFunctionRef<bool(const ULaneConnection*, const UUnrealDriveSubsystem::FConnectionInfo&) > VisitorFunc)
+UUnrealDriveSubsystem::FConnectionInfo* UUnrealDriveSubsystem::FindObservedConnectionByPredicate(TFunctionRef<bool(const ULaneConnection*, const UUnrealDriveSubsystem::FConnectionInfo&) > VisitorFunc)
 {
-	for (auto& [Spline, Connections] : ObservedConnections)
+	for (FObservedConnection& Observed : ObservedConnections)
 	{
-		
-		for (auto& It : Connections)
+		if (auto* Ptr = Observed.Connection.Get())
 		{
-			if (auto* Ptr = It.Key.Get())
+			if (VisitorFunc(Ptr, Observed.Info))
 			{
-				if (VisitorFunc(Ptr, It.Value))
+				if (IsValid(Ptr) && IsValid(Ptr->GetOwnedRoadSpline()))
 				{
-					if (IsValid(Ptr) && IsValid(Ptr->GetOwnedRoadSpline()))
-					{
-						return &It;
-					}
+					return &Observed.Info;
 				}
 			}
 		}
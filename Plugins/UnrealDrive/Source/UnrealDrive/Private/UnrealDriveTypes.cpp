@@ -9,6 +9,7 @@
 #include "DefaultRoadLaneAttributes.h"
 #include "Serialization/ObjectWriter.h"
 #include "Serialization/ObjectReader.h"
+#include "Misc/ScopeRWLock.h"
 
 static FQuat InvertRotation(const FQuat& Quat)
 {
@@ -108,7 +109,174 @@ static bool IsCurveZero(const FRichCurve & Curve, float ErrorTolerance = 2.0)
 
 //----------------------------------------------------------------------------------------
 
+namespace UnrealDrive
+{
+	/**
+	 * Cumulative lane widths (outer lane borders) of one FRoadLaneSection, sampled along the section with a constant SOffset step.
+	 * The step is halved until linear interpolation between samples fits Tolerance at every interval midpoint.
+	 * If the bound can't be reached with MaxSamples the table stays unusable and EvalLaneROffset() falls back to the direct sum.
+	 */
+	struct FLaneWidthPrefixTable
+	{
+		static constexpr double Tolerance = 0.1; // [cm]
+		static constexpr int MinSamples = 16;
+		static constexpr int MaxSamples = 2048;
+
+		FRWLock Lock;
+
+		/** Cache key */
+		const FRoadLayout* Layout = nullptr;
+		uint64 LayoutVersion = 0;
+		double Length = -1.0;
+
+		bool bIsUsable = false;
+		int NumIntervals = 0;
+		int NumRight = 0;
+		int NumColumns = 0;
+		double InvStep = 0.0;
+
+		/** Borders[SampleIndex * NumColumns + Column]. Columns [0..NumRight) are the Right lanes, other ones are the Left lanes */
+		TArray<double> Borders;
+
+		bool IsUpToDate(const FRoadLayout* InLayout, uint64 InLayoutVersion, double InLength) const
+		{
+			return Layout == InLayout && LayoutVersion == InLayoutVersion && Length == InLength;
+		}
+
+		void Build(const FRoadLaneSection& Section, const FRoadLayout* InLayout, uint64 InLayoutVersion, double InLength)
+		{
+			Layout = InLayout;
+			LayoutVersion = InLayoutVersion;
+			Length = InLength;
+			bIsUsable = false;
+			Borders.Empty();
+
+			NumRight = Section.Right.Num();
+			NumColumns = NumRight + Section.Left.Num();
+			if (NumColumns == 0 || Length <= UE_KINDA_SMALL_NUMBER)
+			{
+				return;
+			}
+
+			auto SampleAt = [&Section, this](double LocalS, double* OutBorders)
+			{
+				double Border = 0.0;
+				for (int i = 0; i < NumRight; ++i)
+				{
+					Border += Section.Right[i].EvalWidth(LocalS);
+					OutBorders[i] = Border;
+				}
+				Border = 0.0;
+				for (int i = NumRight; i < NumColumns; ++i)
+				{
+					Border += Section.Left[i - NumRight].EvalWidth(LocalS);
+					OutBorders[i] = Border;
+				}
+			};
+
+			int NumKeys = 0;
+			for (auto& Lane : Section.Right)
+			{
+				NumKeys += Lane.Width.GetNumKeys();
+			}
+			for (auto& Lane : Section.Left)
+			{
+				NumKeys += Lane.Width.GetNumKeys();
+			}
+
+			int N = FMath::Clamp((int)FMath::RoundUpToPowerOfTwo(FMath::Max(NumKeys, 1) * 4), MinSamples, MaxSamples);
+			TArray<double> Values;
+			Values.SetNumUninitialized((N + 1) * NumColumns);
+			for (int i = 0; i <= N; ++i)
+			{
+				SampleAt(Length * i / N, &Values[i * NumColumns]);
+			}
+
+			TArray<double> Midpoints;
+			for (;;)
+			{
+				Midpoints.SetNumUninitialized(N * NumColumns, EAllowShrinking::No);
+				double MaxError = 0.0;
+				for (int i = 0; i < N; ++i)
+				{
+					double* Mid = &Midpoints[i * NumColumns];
+					SampleAt(Length * (i + 0.5) / N, Mid);
+					for (int c = 0; c < NumColumns; ++c)
+					{
+						const double Interpolated = 0.5 * (Values[i * NumColumns + c] + Values[(i + 1) * NumColumns + c]);
+						MaxError = FMath::Max(MaxError, FMath::Abs(Mid[c] - Interpolated));
+					}
+				}
+
+				if (MaxError <= Tolerance)
+				{
+					break;
+				}
+
+				if (N * 2 > MaxSamples)
+				{
+					return;
+				}
+
+				// Midpoints are exactly the new samples of the halved step
+				TArray<double> Refined;
+				Refined.SetNumUninitialized((2 * N + 1) * NumColumns);
+				for (int i = 0; i <= N; ++i)
+				{
+					FMemory::Memcpy(&Refined[2 * i * NumColumns], &Values[i * NumColumns], NumColumns * sizeof(double));
+					if (i < N)
+					{
+						FMemory::Memcpy(&Refined[(2 * i + 1) * NumColumns], &Midpoints[i * NumColumns], NumColumns * sizeof(double));
+					}
+				}
+				Values = MoveTemp(Refined);
+				N *= 2;
+			}
+
+			Borders = MoveTemp(Values);
+			NumIntervals = N;
+			InvStep = N / Length;
+			bIsUsable = true;
+		}
+
+		bool Lookup(int LaneIndex, double LocalS, double Alpha, double& OutROffset) const
+		{
+			if (!bIsUsable)
+			{
+				return false;
+			}
+
+			const int AbsLaneIndex = FMath::Abs(LaneIndex);
+			if (LaneIndex > 0 ? AbsLaneIndex > NumRight : AbsLaneIndex > NumColumns - NumRight)
+			{
+				return false;
+			}
+
+			const double T = LocalS * InvStep;
+			if (T < 0.0 || T > NumIntervals)
+			{
+				return false;
+			}
+
+			const int Interval = FMath::Min((int)T, NumIntervals - 1);
+			const double Frac = T - Interval;
+			const double* Row0 = &Borders[Interval * NumColumns];
+			const double* Row1 = Row0 + NumColumns;
+
+			const int Column = (LaneIndex > 0 ? 0 : NumRight) + AbsLaneIndex - 1;
+			const double BorderOffset = FMath::Lerp(Row0[Column], Row1[Column], Frac);
+			const double PreBorderOffset = AbsLaneIndex > 1 ? FMath::Lerp(Row0[Column - 1], Row1[Column - 1], Frac) : 0.0;
+
+			OutROffset = FMath::Lerp(PreBorderOffset, BorderOffset, Alpha) * (LaneIndex >= 0 ? 1 : -1);
+			return true;
+		}
+	};
+}
+
+//----------------------------------------------------------------------------------------
+
 FRoadLaneSection::FRoadLaneSection()
+	: WidthPrefixTable(MakeShared<UnrealDrive::FLaneWidthPrefixTable, ESPMode::ThreadSafe>())
 {
 }
 
@@ -117,6 +285,7 @@ FRoadLaneSection::~FRoadLaneSection()
 }
 
 FRoadLaneSection::FRoadLaneSection(FRoadLaneSection&& Other) noexcept
+	: WidthPrefixTable(MakeShared<UnrealDrive::FLaneWidthPrefixTable, ESPMode::ThreadSafe>())
 {
 	Side = Other.Side;
 	Left = MoveTemp(Other.Left);
@@ -138,10 +307,12 @@ FRoadLaneSection& FRoadLaneSection::operator = (FRoadLaneSection&& Other) noexce
 	Attributes = MoveTemp(Other.Attributes);
 	OwnedRoadLayout = nullptr;
 	SectionIndex = INDEX_NONE;
+	WidthPrefixTable = MakeShared<UnrealDrive::FLaneWidthPrefixTable, ESPMode::ThreadSafe>();
 	return *this;
 }
 
 FRoadLaneSection::FRoadLaneSection(const FRoadLaneSection& Other) noexcept 
+	: WidthPrefixTable(MakeShared<UnrealDrive::FLaneWidthPrefixTable, ESPMode::ThreadSafe>())
 {
 	Side = Other.Side;
 	Left = Other.Left;
@@ -173,6 +344,7 @@ FRoadLaneSection& FRoadLaneSection::operator= (const FRoadLaneSection& Other) no
 	Attributes = Other.Attributes;
 	OwnedRoadLayout = nullptr;
 	SectionIndex = INDEX_NONE;
+	WidthPrefixTable = MakeShared<UnrealDrive::FLaneWidthPrefixTable, ESPMode::ThreadSafe>();
 
 	for (auto& Lane : Left)
 	{
@@ -282,12 +454,53 @@ double FRoadLaneSection::EvalLaneROffset(int LaneIndex, double InSOffset, double
 
 	check(LaneIndex <= LanesInfo->Num());
 
+	if (OwnedRoadLayout.IsValid())
+	{
+		const FRoadLayout* Layout = *OwnedRoadLayout.Pin();
+		const uint64 LayoutVersion = Layout->GetLayoutVersion();
+		// Lanes of a one-sided section can extend over the following sections, so the table covers the longest lane
+		double SOffsetEnd = SOffsetEnd_Cashed;
+		if (Right.Num())
+		{
+			SOffsetEnd = FMath::Max(SOffsetEnd, Right[0].GetEndOffset());
+		}
+		if (Left.Num())
+		{
+			SOffsetEnd = FMath::Max(SOffsetEnd, Left[0].GetEndOffset());
+		}
+		const double Length = SOffsetEnd - SOffset;
+
+		double ROffset = 0.0;
+		bool bIsUpToDate = false;
+		{
+			FReadScopeLock ReadLock(WidthPrefixTable->Lock);
+			bIsUpToDate = WidthPrefixTable->IsUpToDate(Layout, LayoutVersion, Length);
+			if (bIsUpToDate && WidthPrefixTable->Lookup(LaneIndex, InSOffset - SOffset, Alpha, ROffset))
+			{
+				return ROffset;
+			}
+		}
+
+		if (!bIsUpToDate)
+		{
+			FWriteScopeLock WriteLock(WidthPrefixTable->Lock);
+			if (!WidthPrefixTable->IsUpToDate(Layout, LayoutVersion, Length))
+			{
+				WidthPrefixTable->Build(*this, Layout, LayoutVersion, Length);
+			}
+			if (WidthPrefixTable->Lookup(LaneIndex, InSOffset - SOffset, Alpha, ROffset))
+			{
+				return ROffset;
+			}
+		}
+	}
+
 	double BorderOffset = 0.;
 	double PreBorderOffset = 0.;
 	for (int i = 0; i < FMath::Abs(LaneIndex); ++i)
 	{
 		PreBorderOffset = BorderOffset;
-		BorderOffset += (*LanesInfo)[i].Width.Eval(InSOffset - SOffset);
+		BorderOffset += (*LanesInfo)[i].EvalWidth(InSOffset - SOffset);
 	}
 
 	return FMath::Lerp(PreBorderOffset, BorderOffset, Alpha) * (LaneIndex >= 0 ? 1 : -1);
@@ -473,9 +686,32 @@ void FRoadLayout::UpdateLayout(URoadSplineComponent* OwnedRoadSpline)
 		}
 	}
 
+	CompileCurves();
+	++LayoutVersion;
+}
+
+void FRoadLayout::UpdateLayoutVersion()
+{
+	CompileCurves();
 	++LayoutVersion;
 }
 
+void FRoadLayout::CompileCurves()
+{
+	for (auto& Section : Sections)
+	{
+		for (auto& Lane : Section.Left)
+		{
+			Lane.CompiledWidth.Compile(Lane.Width);
+		}
+		for (auto& Lane : Section.Right)
+		{
+			Lane.CompiledWidth.Compile(Lane.Width);
+		}
+	}
+	CompiledROffset.Compile(ROffset);
+}
+
 void FRoadLayout::UpdateBounds(double SplineLength)
 {
 	if (Sections.Num())
@@ -577,7 +813,19 @@ double FRoadLayout::EvalROffset(double S) const
 	}
 	else
 	{
-		return ROffset.Eval(S);
+		return CompiledROffset.Eval(ROffset, S);
+	}
+}
+
+double FRoadLayout::EvalROffset(double S, int& InOutSpanHint) const
+{
+	if (ROffset.GetNumKeys() == 0)
+	{
+		return 0.0;
+	}
+	else
+	{
+		return CompiledROffset.Eval(ROffset, S, InOutSpanHint);
 	}
 }
 
@@ -687,6 +935,7 @@ FRoadLaneSidewalk::FRoadLaneSidewalk()
 
 //----------------------------------------------------------------------------------------
 int32 URoadConnection::GlobalTransformMagic = 0;
+uint32 URoadConnection::ConnectionsVersion = 0;
 
 URoadConnection::URoadConnection(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -932,6 +1181,7 @@ void URoadConnection::InitConnection()
 		{
 			OuterLaneConnection->Modify();
 			OuterLaneConnection->OuterRoadConnections.Add(this);
+			++ConnectionsVersion;
 		}
 		else
 		{
@@ -949,6 +1199,7 @@ void URoadConnection::Disconnect()
 		OuterLaneConnection->Modify();
 		OuterLaneConnection->OuterRoadConnections.Remove(this);
 		OuterLaneConnection = nullptr;
+		++ConnectionsVersion;
 	}
 }
 
@@ -1264,6 +1515,7 @@ void ULaneConnection::DisconnectAll()
 		}
 	}
 	OuterRoadConnections.Reset();
+	++URoadConnection::ConnectionsVersion;
 }
 
 const FTransform ULaneConnection::EvalTransform(double Alpha, ESplineCoordinateSpace::Type Space) const
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UnrealDrive
+{
+	/**
+	 * Walker's alias table (Vose's construction) for O(1) sampling of the discrete distribution given by the weights.
+	 */
+	struct UNREALDRIVE_API FAliasTable
+	{
+		/** Items with non positive weight are never sampled */
+		void Build(TConstArrayView<double> Weights);
+		void Reset();
+
+		bool IsEmpty() const { return TotalWeight <= 0.0; }
+		int Num() const { return Probabilities.Num(); }
+		double GetTotalWeight() const { return TotalWeight; }
+
+		/** @param U - uniform random value in [0, 1) */
+		int Sample(double U) const
+		{
+			check(!IsEmpty());
+			const double Scaled = U * Probabilities.Num();
+			const int Index = FMath::Min(int(Scaled), Probabilities.Num() - 1);
+			return (Scaled - Index) < Probabilities[Index] ? Index : Aliases[Index];
+		}
+
+		SIZE_T GetAllocatedSize() const { return Probabilities.GetAllocatedSize() + Aliases.GetAllocatedSize(); }
+
+	private:
+		TArray<double> Probabilities;
+		TArray<int> Aliases;
+		double TotalWeight = 0.0;
+	};
+}
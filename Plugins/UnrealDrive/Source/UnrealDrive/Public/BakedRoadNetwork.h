@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class URoadSplineComponent;
+class UWorld;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Flat binary layout of the baked road network (*.udrn file).
+ * All blocks are arrays of the POD structures below, the offsets are relative to the file start.
+ * S is the distance along the road spline [cm], all other offsets are in the road spline space [cm], speeds are in [cm/s].
+ */
+namespace UnrealDrive::BakedRoadNetwork
+{
+	static constexpr uint32 Magic = 0x4E524455; // "UDRN"
+	static constexpr uint32 Version = 1;
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumRoads;
+		uint32 NumLanes;
+		uint32 NumSamples;
+		uint32 NumBorders;
+		uint32 NumSpeedSpans;
+		uint32 NumEdges;
+		uint64 RoadsOffset;
+		uint64 LanesOffset;
+		uint64 SamplesOffset;
+		uint64 BordersOffset;
+		uint64 SpeedSpansOffset;
+		uint64 EdgesOffset;
+		uint64 TotalSize;
+	};
+
+	struct FRoad
+	{
+		double Location[3]; // Road spline component to world transform
+		double Rotation[4];
+		double Scale[3];
+		double Length;
+		uint32 PathNameHash; // FCrc::StrCrc32() of the road spline component path name in the source world
+		uint32 FirstSample;
+		uint32 NumSamples;
+		uint32 FirstLane;
+		uint32 NumLanes;
+		uint32 Padding;
+	};
+
+	/** Sample of the road reference line */
+	struct FSample
+	{
+		double S;
+		float Location[3];
+		float Right[3];
+		float Up[3];
+		float Padding;
+	};
+
+	/** Lane borders at the road sample, ROffset from the reference line including FRoadLayout::ROffset */
+	struct FBorder
+	{
+		float Inner;
+		float Outer;
+	};
+
+	/** Speed limit which starts at S0 and lasts until the next span */
+	struct FSpeedSpan
+	{
+		float S0; // From the lane start
+		float Speed;
+	};
+
+	struct FLane
+	{
+		double S0;
+		double S1;
+		float TravelTime; // [seconds]
+		uint32 RoadIndex;
+		int32 SectionIndex; // Start section of the lane
+		int32 LaneIndex;
+		uint32 bIsForward;
+		uint32 FirstSample; // Road samples covered by the lane, the first one is at S0 and the last one is at S1
+		uint32 NumSamples;
+		uint32 FirstBorder; // NumSamples borders
+		uint32 FirstSpeedSpan;
+		uint32 NumSpeedSpans;
+		uint32 FirstEdge; // Successor lanes (indices in the lanes block) in the travel direction
+		uint32 NumEdges;
+	};
+}
+
+/**
+ * Bakes the road splines to the flat road network data, see UnrealDrive::BakedRoadNetwork.
+ * The centre line of each road is sampled with SampleStep and at all section and lane ends, the lanes and the edges come from FRoadLaneGraph.
+ */
+struct UNREALDRIVE_API FRoadNetworkBaker
+{
+	static void Bake(TConstArrayView<const URoadSplineComponent*> RoadSplines, TArray<uint8>& OutData, double SampleStep = 100.0);
+
+	/** Bake all road splines of the World and save them to GetBakedFileName() */
+	static bool BakeWorld(const UWorld* World, double SampleStep = 100.0);
+};
+
+/**
+ * Read-only view of a baked road network file.
+ * The file is memory mapped if the platform supports it (the file has to be staged outside of the pak files, e.g. with DirectoriesToAlwaysStageAsNonUFS),
+ * otherwise it is loaded to memory. No UObjects are created, all queries work on the mapped data.
+ */
+class UNREALDRIVE_API FBakedRoadNetwork
+{
+public:
+	FBakedRoadNetwork();
+	~FBakedRoadNetwork();
+
+	FBakedRoadNetwork(const FBakedRoadNetwork&) = delete;
+	FBakedRoadNetwork& operator=(const FBakedRoadNetwork&) = delete;
+
+	/** Project relative file name of the baked road network of the World: Content/UnrealDrive/BakedRoadNetworks/<PackagePath>.udrn */
+	static FString GetBakedFileName(const UWorld* World);
+
+	bool Open(const FString& FileName);
+	void Close();
+	bool IsOpen() const { return Header != nullptr; }
+	bool IsMapped() const { return MappedRegion.IsValid(); }
+
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FRoad> GetRoads() const { return Roads; }
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FLane> GetLanes() const { return Lanes; }
+	TConstArrayView<uint32> GetSuccessors(int LaneIndex) const;
+
+	/** @return the road index, or INDEX_NONE */
+	int FindRoad(uint32 PathNameHash) const;
+
+	/** World transform of the lane point, the rotation is along the road spline. S is clamped by the lane bounds */
+	FTransform EvalLaneTransform(int LaneIndex, double S, double Alpha = 0.5) const;
+
+	/** Speed limit at S [cm/s] */
+	double EvalSpeedLimit(int LaneIndex, double S) const;
+
+private:
+	bool Validate(const uint8* InData, int64 InSize);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray64<uint8> LoadedData;
+
+	const UnrealDrive::BakedRoadNetwork::FHeader* Header = nullptr;
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FRoad> Roads;
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FLane> Lanes;
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FSample> Samples;
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FBorder> Borders;
+	TConstArrayView<UnrealDrive::BakedRoadNetwork::FSpeedSpan> SpeedSpans;
+	TConstArrayView<uint32> Edges;
+};
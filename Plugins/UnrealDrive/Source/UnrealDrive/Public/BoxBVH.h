@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UnrealDrive
+{
+	/**
+	 * Static bounding volume hierarchy over a set of boxes, built top-down by the median split along the longest axis.
+	 * Items are referenced by their index in the array passed to Build().
+	 */
+	class UNREALDRIVE_API FBoxBVH
+	{
+	public:
+		void Build(TConstArrayView<FBox> ItemBounds, int MaxLeafSize = 4);
+		void Reset();
+
+		bool IsEmpty() const { return Nodes.Num() == 0; }
+		FBox GetBounds() const { return Nodes.Num() ? Nodes[0].Bounds : FBox(ForceInit); }
+
+		/** Visit all items whose bounds intersect Box. Visitor is bool(int ItemIndex), return false to stop the query */
+		template <typename FVisitor>
+		void Query(const FBox& Box, FVisitor&& Visitor) const
+		{
+			QueryByPredicate([&Box](const FBox& Bounds) { return Bounds.Intersect(Box); }, Forward<FVisitor>(Visitor));
+		}
+
+		/**
+		 * Visit all items whose bounds pass the BoxTest, e.g. a frustum test. BoxTest is bool(const FBox&), it is called for the nodes and for the items.
+		 * Visitor is bool(int ItemIndex), return false to stop the query
+		 */
+		template <typename FBoxTest, typename FVisitor>
+		void QueryByPredicate(FBoxTest&& BoxTest, FVisitor&& Visitor) const
+		{
+			if (Nodes.Num() == 0)
+			{
+				return;
+			}
+
+			TArray<int, TInlineAllocator<64>> Stack;
+			Stack.Push(0);
+			while (Stack.Num())
+			{
+				const FNode& Node = Nodes[Stack.Pop(EAllowShrinking::No)];
+				if (!BoxTest(Node.Bounds))
+				{
+					continue;
+				}
+
+				if (Node.Count > 0)
+				{
+					for (int i = Node.First; i < Node.First + Node.Count; ++i)
+					{
+						if (BoxTest(ItemBounds[ItemIndices[i]]) && !Visitor(ItemIndices[i]))
+						{
+							return;
+						}
+					}
+				}
+				else
+				{
+					Stack.Push(Node.First);
+					Stack.Push(Node.First + 1);
+				}
+			}
+		}
+
+		SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + ItemIndices.GetAllocatedSize() + ItemBounds.GetAllocatedSize(); }
+
+	private:
+		struct FNode
+		{
+			FBox Bounds;
+			int First = 0; // Leaf: first item in ItemIndices; Inner node: left child, the right child is First + 1
+			int Count = 0; // Leaf: number of items; Inner node: 0
+		};
+
+		TArray<FNode> Nodes;
+		TArray<int> ItemIndices;
+		TArray<FBox> ItemBounds;
+	};
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Curves/RichCurve.h"
+#include "Math/InterpCurve.h"
+#include "Algo/BinarySearch.h"
+
+namespace UnrealDrive
+{
+	/**
+	 * FRichCurve flattened to cubic polynomial spans.
+	 * Span i covers [Breakpoints[i], Breakpoints[i + 1]) and evaluates C0 + C1*t + C2*t^2 + C3*t^3, where t = (Time - Breakpoints[i]) * InvDuration.
+	 * Only constant extrapolation and unweighted tangents are compiled, other curves fall back to FRichCurve::Eval().
+	 */
+	struct UNREALDRIVE_API FCompiledCurve
+	{
+		struct FSpan
+		{
+			double C0 = 0;
+			double C1 = 0;
+			double C2 = 0;
+			double C3 = 0;
+			double InvDuration = 0;
+		};
+
+		void Compile(const FRichCurve& Curve);
+		void Reset();
+
+		/**
+		 * The compiled spans aren't checked against the curve, they stay valid until the next change of the curve. 
+		 * The owner must recompile the curve on each change, see FRoadLayout::UpdateLayoutVersion()
+		 */
+		bool IsCompiled() const { return bIsCompiled; }
+
+		/** Evaluate the compiled spans, or the Curve itself if it can't be compiled */
+		double Eval(const FRichCurve& Curve, double Time) const
+		{
+			return IsCompiled() ? EvalCompiled(Time) : Curve.Eval(Time);
+		}
+
+		/** The same as Eval(), but the span search starts from InOutSpanHint. Amortized O(1) if Time changes slowly between the calls */
+		double Eval(const FRichCurve& Curve, double Time, int& InOutSpanHint) const
+		{
+			return IsCompiled() ? EvalCompiled(Time, InOutSpanHint) : Curve.Eval(Time);
+		}
+
+		double EvalCompiled(double Time) const
+		{
+			if (Spans.Num() == 0 || Time <= Breakpoints[0])
+			{
+				return PreValue;
+			}
+			if (Time >= Breakpoints.Last())
+			{
+				return PostValue;
+			}
+			const int SpanIndex = FindSpan(Time);
+			const FSpan& Span = Spans[SpanIndex];
+			const double T = (Time - Breakpoints[SpanIndex]) * Span.InvDuration;
+			return Span.C0 + T * (Span.C1 + T * (Span.C2 + T * Span.C3));
+		}
+
+		double EvalCompiled(double Time, int& InOutSpanHint) const
+		{
+			if (Spans.Num() == 0 || Time <= Breakpoints[0])
+			{
+				return PreValue;
+			}
+			if (Time >= Breakpoints.Last())
+			{
+				return PostValue;
+			}
+			int SpanIndex = InOutSpanHint;
+			if (!Spans.IsValidIndex(SpanIndex) || Time < Breakpoints[SpanIndex])
+			{
+				SpanIndex = FindSpan(Time);
+			}
+			else if (Time >= Breakpoints[SpanIndex + 1])
+			{
+				SpanIndex = (SpanIndex + 2 < Breakpoints.Num() && Time < Breakpoints[SpanIndex + 2]) ? SpanIndex + 1 : FindSpan(Time);
+			}
+			InOutSpanHint = SpanIndex;
+			const FSpan& Span = Spans[SpanIndex];
+			const double T = (Time - Breakpoints[SpanIndex]) * Span.InvDuration;
+			return Span.C0 + T * (Span.C1 + T * (Span.C2 + T * Span.C3));
+		}
+
+		/** @return the last span whose breakpoint <= Time. The search is branchless, so the loop is compiled to conditional moves */
+		int FindSpan(double Time) const
+		{
+			const double* Data = Breakpoints.GetData();
+			int Base = 0;
+			int Len = Spans.Num();
+			while (Len > 1)
+			{
+				const int Half = Len >> 1;
+				Base = (Data[Base + Half] <= Time) ? Base + Half : Base;
+				Len -= Half;
+			}
+			return Base;
+		}
+
+		SIZE_T GetAllocatedSize() const { return Breakpoints.GetAllocatedSize() + Spans.GetAllocatedSize(); }
+
+	private:
+		TArray<double> Breakpoints;
+		TArray<FSpan> Spans;
+		double PreValue = 0;
+		double PostValue = 0;
+		bool bIsCompiled = false;
+	};
+
+	/**
+	 * Evaluate the spline reparam table (distance -> input key, linear points) starting the search from InOutPointHint.
+	 * Amortized O(1) if the distance changes slowly between the calls, otherwise falls back to the binary search.
+	 */
+	inline float EvalReparamTable(const FInterpCurveFloat& Table, double Distance, int& InOutPointHint)
+	{
+		const TArray<FInterpCurvePoint<float>>& Points = Table.Points;
+		const float Key = float(Distance);
+
+		if (Points.Num() < 2 || Key <= Points[0].InVal)
+		{
+			return Points.Num() ? Points[0].OutVal : 0.0f;
+		}
+		if (Key >= Points.Last().InVal)
+		{
+			return Points.Last().OutVal;
+		}
+
+		int Index = FMath::Clamp(InOutPointHint, 0, Points.Num() - 2);
+		for (int Step = 0; Step < 4 && Points[Index + 1].InVal <= Key; ++Step)
+		{
+			++Index;
+		}
+		for (int Step = 0; Step < 4 && Points[Index].InVal > Key; ++Step)
+		{
+			--Index;
+		}
+		if (Points[Index].InVal > Key || Points[Index + 1].InVal <= Key)
+		{
+			Index = FMath::Max(Algo::UpperBoundBy(Points, Key, [](const FInterpCurvePoint<float>& Point) { return Point.InVal; }) - 1, 0);
+		}
+		InOutPointHint = Index;
+
+		const FInterpCurvePoint<float>& Point0 = Points[Index];
+		const FInterpCurvePoint<float>& Point1 = Points[Index + 1];
+		if (Point0.InterpMode != CIM_Linear)
+		{
+			return Table.Eval(Key, 0.0f);
+		}
+		const float Diff = Point1.InVal - Point0.InVal;
+		return Diff > 0.0f ? FMath::Lerp(Point0.OutVal, Point1.OutVal, (Key - Point0.InVal) / Diff) : Point0.OutVal;
+	}
+}
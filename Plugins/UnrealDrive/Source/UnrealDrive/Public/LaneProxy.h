@@ -18,43 +18,224 @@ struct HRoadSplineVisProxy;
 namespace UnrealDrive
 {
 
+struct FLaneProxy;
+struct FRoadMeshChunk;
+
+/** Max number of the LODs of the lane meshes, see UUnrealDriveSettings::LaneMeshLODScreenSizes */
+static constexpr int MaxRoadMeshLODs = 4;
+
+/**
+ * Vertex and index buffers of the FRoadMeshChunk, each lane of the chunk is a sub-range of the buffers (see FLaneProxy)
+ */
+struct FRoadMeshBuffers
+{
+	/** Index range of the lanes with the same material and LOD, they are contiguous in the index buffer */
+	struct FMaterialBatch
+	{
+		FMaterialRenderProxy* Material = nullptr;
+		int LODIndex = 0;
+		uint32 FirstIndex = 0;
+		uint32 NumPrimitives = 0;
+		uint32 MinVertexIndex = 0;
+		uint32 MaxVertexIndex = 0;
+	};
+
+	struct FLaneRange
+	{
+		uint32 FirstIndex = 0;
+		uint32 NumPrimitives = 0;
+		uint32 MinVertexIndex = 0;
+		uint32 MaxVertexIndex = 0;
+	};
+
+	FRoadMeshBuffers(ERHIFeatureLevel::Type InFeatureLevel)
+		: VertexFactory(InFeatureLevel, "RoadMesh")
+		, FeatureLevel(InFeatureLevel)
+	{
+	}
+
+	~FRoadMeshBuffers() { ReleaseResources(); }
+
+	/** Pack the indices of the chunk lanes grouped by the LOD and the material, fill LaneRanges and MaterialBatches and init the render resources */
+	void Build(const FRoadMeshChunk& Chunk);
+
+	void ReleaseResources();
+
+	bool IsEmpty() const { return IndexBuffer.Indices.Num() == 0; }
+
+	/** CPU memory of the ranges and of the CPU copies of the vertex and index data */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Size of the vertex and index buffers in the video memory */
+	SIZE_T GetGPUMemorySize() const;
+
+	void InitMeshBatch(const class FPrimitiveSceneProxy& SceneProxy, FMeshBatch& MeshBatch) const;
+	void DrawStaticElements(const class FPrimitiveSceneProxy& SceneProxy, FStaticPrimitiveDrawInterface* PDI) const;
+
+	/** Per FRoadMeshChunk::Lanes, per LOD */
+	TArray<TStaticArray<FLaneRange, MaxRoadMeshLODs>> LaneRanges;
+
+	/** Sorted by the LOD */
+	TArray<FMaterialBatch> MaterialBatches;
+
+	/** Copy of FRoadMeshChunk::NumLODs and FRoadMeshChunk::LODScreenSizes */
+	int NumLODs = 1;
+	float LODScreenSizes[MaxRoadMeshLODs] = { FLT_MAX };
+
+	FStaticMeshVertexBuffers VertexBuffers;
+	FDynamicMeshIndexBuffer32 IndexBuffer;
+	FLocalVertexFactory VertexFactory;
+	ERHIFeatureLevel::Type FeatureLevel;
+	bool bIsInitialized = false;
+};
+
+/**
+ * CPU side lanes of one lane section of the road spline (or the filled closed loop). Immutable after the build.
+ * Unchanged chunks are moved from the previous FRoadMeshData to the next one, together with their GPU buffers.
+ */
+struct FRoadMeshChunk
+{
+	struct FLane
+	{
+		int SectionIndex = INDEX_NONE; // INDEX_NONE for the filled closed loop
+		int LaneIndex = 0;
+		TArray<FVector> LanePoints;
+		FLinearColor LineColor{ FColor(255, 255, 255) };
+		FMaterialRenderProxy* Material = nullptr;
+
+		/** Triangles in the FRoadMeshChunk::Vertices per LOD, LOD0 is empty if the lane has no mesh. The LODs share the vertices */
+		TArray<uint32> LODIndices[MaxRoadMeshLODs];
+		uint32 MinVertexIndex = 0;
+		uint32 MaxVertexIndex = 0;
+
+		/** Triangles of the LOD, or of the nearest finer LOD if the lane has no such LOD (e.g. the filled closed loop) */
+		const TArray<uint32>& GetIndices(int LODIndex) const
+		{
+			while (LODIndex > 0 && LODIndices[LODIndex].Num() == 0)
+			{
+				--LODIndex;
+			}
+			return LODIndices[LODIndex];
+		}
+	};
+
+	/** Section index of the chunk, INDEX_NONE for the filled closed loop */
+	int SectionIndex = INDEX_NONE;
+
+	/** Hash of all inputs of the chunk mesh, see FRoadMeshData::Build() */
+	uint32 Hash = 0;
+
+	TArray<FDynamicMeshVertex> Vertices;
+	TArray<FLane> Lanes;
+
+	/** Local space bounds of the lane meshes and the lane points, used for the per chunk culling of the scene proxy */
+	FBox Bounds{ ForceInit };
+
+	/** Number of the LODs of the lane meshes and the max screen size of each LOD. The same for all chunks of the FRoadMeshData */
+	int NumLODs = 1;
+	float LODScreenSizes[MaxRoadMeshLODs] = { FLT_MAX };
+
+	/** @return the coarsest LOD whose max screen size isn't less than the ScreenSize (see ComputeBoundsScreenSize()) */
+	int ComputeLOD(float ScreenSize) const
+	{
+		for (int LODIndex = NumLODs - 1; LODIndex > 0; --LODIndex)
+		{
+			if (ScreenSize <= LODScreenSizes[LODIndex])
+			{
+				return LODIndex;
+			}
+		}
+		return 0;
+	}
+
+	/** 
+	 * GPU buffers of the chunk. Created by the first scene proxy and shared by the next proxies, so only the rebuilt chunks are uploaded.
+	 * Recreated if the FeatureLevel differs (e.g. the preview feature level is switched), the proxies keep their previous buffers alive
+	 */
+	TSharedRef<FRoadMeshBuffers> GetBuffers(ERHIFeatureLevel::Type FeatureLevel) const;
+
+	/** CPU memory of the vertices and the lanes, the buffers aren't included */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	mutable TSharedPtr<FRoadMeshBuffers> Buffers;
+	mutable FCriticalSection BuffersLock;
+};
+
+/**
+ * CPU side lane meshes of the road spline split into the per section chunks. Built from the road spline on any thread, immutable after the build 
+ * and shared by the scene proxies until the road spline is changed (see URoadSplineComponent::GetRoadMeshData()).
+ */
+struct FRoadMeshData
+{
+	TArray<TSharedPtr<const FRoadMeshChunk>> Chunks;
+
+	/** Versions of the road spline the mesh was built from */
+	uint64 SplineCurvesVersion = 0;
+	uint64 LayoutVersion = 0;
+
+	bool IsUpToDate(const URoadSplineComponent* Component) const;
+
+	/** CPU memory of the chunks, the chunks shared with the other FRoadMeshData are included too */
+	SIZE_T GetAllocatedSize() const;
+
+	/** 
+	 * Only reads the Component, so it's safe to call on a worker thread for a component which isn't edited meanwhile.
+	 * The chunks of the Previous data with the same section index and hash are reused instead of the rebuild.
+	 */
+	static TSharedRef<FRoadMeshData> Build(const URoadSplineComponent* Component, const FRoadMeshData* Previous = nullptr);
+};
+
+/**
+ * Render thread part of the lane, the lane points are owned by the FRoadMeshChunk
+ */
 struct FLaneProxy
 {
-	FLaneProxy(int InSectionIndex, int InLaneIndex, ERHIFeatureLevel::Type InFeatureLevel) 
-		: SectionIndex(InSectionIndex)
-		, LaneIndex(InLaneIndex)
-		, VertexFactory(InFeatureLevel, "RoadMesh")
+	FLaneProxy(const FRoadMeshChunk::FLane& Lane) 
+		: SectionIndex(Lane.SectionIndex)
+		, LaneIndex(Lane.LaneIndex)
+		, LanePoints(Lane.LanePoints)
+		, Material(Lane.Material)
+		, LineColor(Lane.LineColor)
 	{
 	}
 	//FLaneProxy(const FLaneProxy& Other) = default;
 	//FLaneProxy(FLaneProxy&& Other) = default;
 
-	virtual ~FLaneProxy() { ReleaseResources(); }
+	virtual ~FLaneProxy() {}
 
-	virtual void InitMesh(TArray<FDynamicMeshVertex>& Vertices, TArray<uint32>& Indices);
-	virtual void ReleaseResources();
-	virtual FMeshBatch * GetDynamicMeshElements(const class FPrimitiveSceneProxy & SceneProxy, const FSceneView*& Views, const FSceneViewFamily& ViewFamily, FPrimitiveDrawInterface* PDI, FMeshElementCollector& Collector) const;
+	virtual FMeshBatch * GetDynamicMeshElements(const class FPrimitiveSceneProxy & SceneProxy, const FSceneView*& Views, const FSceneViewFamily& ViewFamily, FPrimitiveDrawInterface* PDI, FMeshElementCollector& Collector, int LODIndex = 0) const;
+	virtual void DrawStaticElements(const class FPrimitiveSceneProxy& SceneProxy, FStaticPrimitiveDrawInterface* PDI) const;
 	virtual void DrawLines(const FMatrix& LocalToWorld, FPrimitiveDrawInterface* PDI, bool bIsSelected) const;
 
 #if WITH_EDITOR
-	virtual HRoadSplineVisProxy* CreateHitProxy(const URoadSplineComponent* Component);
+	/** @param bIsLayoutUpToDate - false if the lane was built from the previous layout of the Component, then the lane is hit as the whole road */
+	virtual HRoadSplineVisProxy* CreateHitProxy(const URoadSplineComponent* Component, bool bIsLayoutUpToDate = true);
 #endif
 
+	bool HasMesh() const { return Buffers && Ranges[0].NumPrimitives > 1; }
+
+	/** Fill the mesh batch shared by the static and the dynamic draw paths, the primitive uniform buffer isn't set */
+	void InitMeshBatch(const class FPrimitiveSceneProxy& SceneProxy, FMeshBatch& MeshBatch, int LODIndex = 0) const;
+
 	int SectionIndex = -1;
 	int LaneIndex = 0;
-	TArray<FVector> LanePoints;
-	FStaticMeshVertexBuffers VertexBuffers;
-	FDynamicMeshIndexBuffer32 IndexBuffer;
-	FLocalVertexFactory VertexFactory;
+	int ChunkIndex = INDEX_NONE; // Index in FRoadMeshData::Chunks
+	TConstArrayView<FVector> LanePoints;
 	FMaterialRenderProxy* Material = nullptr;
 	FLinearColor LineColor{ FColor(255, 255, 255) };
 
+	/** Sub-ranges of the Buffers per LOD */
+	const FRoadMeshBuffers* Buffers = nullptr;
+	FRoadMeshBuffers::FLaneRange Ranges[MaxRoadMeshLODs];
+	int NumLODs = 1;
+
 #if WITH_EDITOR
 	TRefCountPtr<HRoadSplineVisProxy> HitProxy;
 #endif
 
-	static TArray<TSharedPtr<FLaneProxy>> MakeLaneProxysFromSpline(URoadSplineComponent* InComponent, ERHIFeatureLevel::Type InFeatureLevel);
-	static TSharedPtr<FLaneProxy> MakeLoopProxyFromSpline(URoadSplineComponent* InComponent, ERHIFeatureLevel::Type InFeatureLevel);
+	/** The MeshData must outlive the lane proxies. OutBuffers are the GPU buffers of the MeshData chunks */
+	static TArray<TSharedPtr<FLaneProxy>> MakeLaneProxies(const FRoadMeshData& MeshData, ERHIFeatureLevel::Type FeatureLevel, TArray<TSharedPtr<FRoadMeshBuffers>>& OutBuffers);
 };
 
 } // UnrealDrive
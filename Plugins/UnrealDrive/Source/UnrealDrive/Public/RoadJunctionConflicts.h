@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FRoadLaneGraph;
+class URoadSplineComponent;
+
+enum class ERoadLaneConflictType : uint8
+{
+	Crossing,
+	Merging,   // Lanes end at the same location
+	Diverging, // Lanes start at the same location
+};
+
+/**
+ * Overlap of two junction lanes. S ranges are in the SOffset space of the lane road spline (see FRoadLaneGraph::FNode::SOffset0/1)
+ */
+struct FRoadLaneConflict
+{
+	int OtherNode = INDEX_NONE;
+	ERoadLaneConflictType Type = ERoadLaneConflictType::Crossing;
+	float S0 = 0;
+	float S1 = 0;
+	float OtherS0 = 0;
+	float OtherS1 = 0;
+};
+
+/**
+ * Precomputed conflict zones of the junction lanes.
+ * A junction lane is a lane of the road spline whose both road connections are connected to the lanes of two other roads, and at least one of 
+ * these road ends has more than one road attached (see URoadConnection, IsJunctionRoad()). The lanes of a plain chain of roads aren't junction lanes.
+ * The centre lines of the junction lanes are sampled, and for each pair of the overlapped lanes of the different roads, which don't continue each other, the S ranges where
+ * the lanes overlap are stored. The conflicts are stored per FRoadLaneGraph node in the compressed sparse row format and sorted by S0.
+ */
+class UNREALDRIVE_API FRoadJunctionConflicts
+{
+public:
+	/**
+	 * Rebuild the conflicts of all junction lanes of the LaneGraph. Must be called after each change of the LaneGraph, since the conflicts refer to the graph nodes.
+	 * @param SampleStep - step of the lanes sampling along S [cm], the conflict ranges are conservative within this step
+	 */
+	void Build(const FRoadLaneGraph& LaneGraph, double SampleStep = 50.0);
+
+	void Reset();
+
+	bool IsEmpty() const { return Conflicts.Num() == 0; }
+
+	TConstArrayView<FRoadLaneConflict> GetConflicts(int NodeIndex) const
+	{
+		if (!Offsets.IsValidIndex(NodeIndex + 1))
+		{
+			return {};
+		}
+		return MakeArrayView(Conflicts.GetData() + Offsets[NodeIndex], Offsets[NodeIndex + 1] - Offsets[NodeIndex]);
+	}
+
+	const FRoadLaneConflict* FindConflict(int NodeIndex, int OtherNodeIndex) const;
+
+	SIZE_T GetAllocatedSize() const { return Offsets.GetAllocatedSize() + Conflicts.GetAllocatedSize(); }
+
+	static bool IsJunctionRoad(const URoadSplineComponent* RoadSpline);
+
+private:
+	TArray<int> Offsets;
+	TArray<FRoadLaneConflict> Conflicts;
+};
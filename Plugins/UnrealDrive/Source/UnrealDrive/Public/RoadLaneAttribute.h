@@ -187,6 +187,19 @@ public:
 	/** Gets the handle for the last key which is at or before the SOffset requested.  If there are no keys at or before the requested SOffset, an invalid handle is returned. */
 	int FindKeyBeforeOrAt(double KeySOffset) const;
 
+	/** 
+	 * Finds the keys which are active inside the [S0, S1] interval, including the key active at S0. 
+	 * If S0 is before the first key, the range starts from the first key.
+	 * @return false if no keys overlap the interval
+	 */
+	bool FindKeysInRange(double S0, double S1, int& OutStartKey, int& OutEndKey) const;
+
+	/** 
+	 * Visits all keys spans which overlap the [S0, S1] interval. 
+	 * Span bounds are clamped by the interval, so the span of the last visited key always ends at S1.
+	 */
+	void ForEachSpanInRange(double S0, double S1, TFunctionRef<void(int KeyIndex, double SpanS0, double SpanS1)> Visitor) const;
+
 	/** Tries to reduce the number of keys required for accurate evaluation (zero error threshold) */
 	void RemoveRedundantKeys();
 
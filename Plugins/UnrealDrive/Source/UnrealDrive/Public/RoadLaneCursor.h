@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RoadSplineComponent.h"
+
+class FRoadLaneGraph;
+struct FRoadLaneRoute;
+
+/**
+ * Lightweight cursor for the agents which follow a road lane with small steps.
+ * The cursor keeps the search hints of the spline reparam table, the ROffset and the lane width curves spans and the lane attribute keys,
+ * so each Advance() and evaluation is amortized O(1) instead of the full search done by URoadSplineComponent::GetRoadPosition().
+ * At the end of the lane the cursor switches to the successor lane from the FRoadLaneGraph.
+ * The cursor doesn't hold the road spline, it must be reset if the road spline or its layout is changed.
+ */
+class UNREALDRIVE_API FRoadLaneCursor
+{
+public:
+	FRoadLaneCursor() = default;
+
+	/** See SetLane() */
+	FRoadLaneCursor(const URoadSplineComponent* RoadSpline, int SectionIndex, int LaneIndex, double SOffset, double Alpha = 0.5);
+
+	/**
+	 * Place the cursor on the lane.
+	 * @param SectionIndex - any section covered by the lane
+	 * @param Alpha - position across the lane, 0 is the inner border and 1 is the outer border
+	 * @return false if the lane isn't found
+	 */
+	bool SetLane(const URoadSplineComponent* RoadSpline, int SectionIndex, int LaneIndex, double SOffset, double Alpha = 0.5);
+
+	/**
+	 * Move the cursor along the travel direction of the lane.
+	 * At the lane end the cursor switches to the successor lane from the LaneGraph: the next lane of the Route if it is given, otherwise the first successor.
+	 * @return the remaining distance which wasn't passed because there is no successor lane
+	 */
+	double Advance(double Distance, const FRoadLaneGraph* LaneGraph = nullptr, const FRoadLaneRoute* Route = nullptr);
+
+	bool IsValid() const { return RoadSpline != nullptr; }
+	void Reset();
+
+	const URoadSplineComponent* GetRoadSpline() const { return RoadSpline; }
+	const FRoadLane& GetLane() const { check(Lane); return *Lane; }
+	int GetSectionIndex() const { return SectionIndex; }
+	int GetLaneIndex() const { return LaneIndex; }
+	bool IsForward() const { return bIsForward; }
+	double GetSOffset() const { return SOffset; }
+	double GetAlpha() const { return Alpha; }
+	void SetAlpha(double InAlpha) { Alpha = InAlpha; }
+
+	/** Distance to the lane end along the travel direction */
+	double GetDistanceToLaneEnd() const { return bIsForward ? LaneSOffset1 - SOffset : SOffset - LaneSOffset0; }
+
+	double GetLaneWidth() const;
+	double GetROffset() const;
+
+	/** The same as URoadSplineComponent::GetRoadPosition(SectionIndex, LaneIndex, Alpha, SOffset). Note, the rotation is along the spline, not along the travel direction */
+	FRoadPosition GetRoadPosition(ESplineCoordinateSpace::Type CoordinateSpace) const;
+
+	/** Value of the attribute key active at the cursor */
+	template<typename AttributeType>
+	const AttributeType* GetAttributeValue(FName AttributeName) const
+	{
+		const FRoadLaneAttribute* Attribute = nullptr;
+		const int KeyIndex = FindAttributeKey(AttributeName, Attribute);
+		return KeyIndex != INDEX_NONE ? Attribute->Keys[KeyIndex].GetValuePtr<AttributeType>() : nullptr;
+	}
+
+	/** Speed limit from the UnrealDrive::LaneAttributes::Speed attribute, or the FRaodLaneSpeed default [cm/s] */
+	double GetSpeedLimit() const;
+
+private:
+	void SetLaneInner(const URoadSplineComponent* InRoadSpline, int InSectionIndex, int InLaneIndex, double InSOffset);
+	bool SwitchToSuccessor(const FRoadLaneGraph& LaneGraph, const FRoadLaneRoute* Route);
+	int FindAttributeKey(FName AttributeName, const FRoadLaneAttribute*& OutAttribute) const;
+
+	const URoadSplineComponent* RoadSpline = nullptr;
+	const FRoadLane* Lane = nullptr;
+	int SectionIndex = INDEX_NONE; // Start section of the lane
+	int LaneIndex = LANE_INDEX_NONE;
+	bool bIsForward = true;
+	double SOffset = 0;
+	double Alpha = 0.5;
+	double LaneSOffset0 = 0;
+	double LaneSOffset1 = 0;
+
+	/** Index of the current lane in the route, used by Advance() */
+	int RouteIndex = INDEX_NONE;
+
+	/** Search hints */
+	mutable int ReparamHint = 0;
+	mutable int ROffsetSpanHint = 0;
+	mutable TArray<int, TInlineAllocator<8>> WidthSpanHints; // For the lanes from 1 to |LaneIndex| of the start section
+
+	struct FAttributeHint
+	{
+		FName Name;
+		const FRoadLaneAttribute* Attribute = nullptr;
+		int KeyIndex = INDEX_NONE;
+	};
+	mutable TArray<FAttributeHint, TInlineAllocator<2>> AttributeHints;
+};
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UnrealDriveTypes.h"
+
+class URoadSplineComponent;
+
+/**
+ * Position on a road lane, used as the start and the goal of the FRoadLaneGraph::FindRoute()
+ */
+struct FRoadLaneLocation
+{
+	const URoadSplineComponent* RoadSpline = nullptr;
+	int SectionIndex = INDEX_NONE;
+	int LaneIndex = LANE_INDEX_NONE;
+	double SOffset = 0; // The same as for URoadSplineComponent::EvalLanePoistion()
+};
+
+/**
+ * Result of the FRoadLaneGraph::FindRoute()
+ */
+struct FRoadLaneRoute
+{
+	/** Graph nodes from the start lane to the goal lane */
+	TArray<int> Nodes;
+
+	/** Travel time from the start location to the goal location [seconds] */
+	double TravelTime = 0;
+
+	/** Length along the lanes from the start location to the goal location [cm] */
+	double Length = 0;
+
+	bool IsValid() const { return Nodes.Num() > 0; }
+};
+
+/**
+ * Compiled lane graph of the road network.
+ * Each FRoadLane is a node, and the edges go from a lane to the lanes which continue it in the travel direction:
+ *  - the lane with the same index in the next (or previous for backward lanes) section of the same road;
+ *  - the lanes of the roads connected to the lane connections (see URoadConnection / ULaneConnection).
+ * The edges are stored in the compressed sparse row format. The weight of the edge is the travel time of the target lane,
+ * which is evaluated from the lane length and the lane speed attribute (see UnrealDrive::LaneAttributes::Speed).
+ */
+class UNREALDRIVE_API FRoadLaneGraph
+{
+public:
+	struct FNode
+	{
+		const URoadSplineComponent* RoadSpline = nullptr;
+		int SectionIndex = INDEX_NONE; // Start section of the lane
+		int LaneIndex = LANE_INDEX_NONE;
+		bool bIsForward = true;
+		double SOffset0 = 0;
+		double SOffset1 = 0;
+		double TravelTime = 0; // [seconds]
+		double MaxSpeed = 0; // Max speed on the lane [cm/s]
+		FVector TravelStartLocation = FVector::ZeroVector; // [world]
+		FVector TravelEndLocation = FVector::ZeroVector; // [world]
+
+		double GetLength() const { return SOffset1 - SOffset0; }
+	};
+
+	/**
+	 * Rebuild the nodes of the changed road splines (spline curves, layout or attributes version, or transform), and relink the edges if any spline or any road connection was changed.
+	 * Game thread only.
+	 * @return true if the graph was changed
+	 */
+	bool Update(TConstArrayView<const URoadSplineComponent*> RoadSplines);
+
+	void Reset();
+
+	int NumNodes() const { return Nodes.Num(); }
+	const FNode& GetNode(int NodeIndex) const { return Nodes[NodeIndex]; }
+	int FindNode(const URoadSplineComponent* RoadSpline, int SectionIndex, int LaneIndex) const;
+
+	TConstArrayView<int> GetSuccessors(int NodeIndex) const
+	{
+		return MakeArrayView(Targets.GetData() + Offsets[NodeIndex], Offsets[NodeIndex + 1] - Offsets[NodeIndex]);
+	}
+
+	/**
+	 * Find the fastest route from the Start to the Goal.
+	 * @param bUseHeuristic - if true, A* is used (straight distance divided by the max speed of the graph), otherwise Dijkstra
+	 * @return false if the Goal isn't reachable
+	 */
+	bool FindRoute(const FRoadLaneLocation& Start, const FRoadLaneLocation& Goal, FRoadLaneRoute& OutRoute, bool bUseHeuristic = true) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	/** Default speed of the lanes without the speed attribute [cm/s] */
+	static double GetDefaultSpeed();
+
+private:
+	struct FSplineNodes
+	{
+		uint64 SplineCurvesVersion = 0;
+		uint64 LayoutVersion = 0;
+		uint64 AttributesVersion = 0; // The travel times depend on the Speed lane attribute
+		FTransform Transform;
+		bool bIsBuilt = false;
+		TArray<FNode> Nodes;
+	};
+
+	static void BuildSplineNodes(const URoadSplineComponent* RoadSpline, TArray<FNode>& OutNodes);
+	static double EvalTravelTime(const FRoadLane& Lane, double S0, double S1, double* OutMaxSpeed = nullptr);
+	void BuildEdges();
+	void AddLaneSuccessors(int NodeIndex, TArray<int, TInlineAllocator<8>>& OutSuccessors) const;
+	int ResolveNode(const FRoadLaneLocation& Location) const;
+	int FindRoadEndNode(const URoadSplineComponent* RoadSpline, bool bAtStart, int Side, bool bDeparting) const;
+
+	TMap<const URoadSplineComponent*, FSplineNodes> SplineNodes;
+	uint32 ConnectionsVersion = 0;
+
+	TArray<FNode> Nodes;
+	TMap<TTuple<const URoadSplineComponent*, int, int>, int> NodesMap;
+	TArray<int> Offsets;
+	TArray<int> Targets;
+	double MaxSpeed = 0; // [cm/s]
+};
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "BoxBVH.h"
+#include "RoadLaneGraph.h"
+#include "RoadJunctionConflicts.h"
+#include "UnrealDriveTypes.h"
+#include "RoadLaneIndexSubsystem.generated.h"
+
+class URoadSplineComponent;
+
+/**
+ * Result of the URoadLaneIndexSubsystem::ProjectPoints()
+ */
+struct FRoadLaneProjection
+{
+	const URoadSplineComponent* RoadSpline = nullptr;
+	int SectionIndex = INDEX_NONE;
+	int LaneIndex = LANE_INDEX_NONE;
+	double SOffset = 0;
+	double ROffset = 0; // Right offset from the spline, the same as for URoadSplineComponent::GetRoadPosition(SOffset, ROffset)
+	double Height = 0; // Distance from the road surface along the spline up vector
+
+	bool IsValid() const { return RoadSpline != nullptr; }
+};
+
+/**
+ * Runtime spatial index of the road lanes of all URoadSplineComponents in the world.
+ * Each road spline is split to short slices along S, the slices are kept in a per spline BVH, and the splines are kept in the top level BVH.
+ * Only the changed splines (spline curves, layout version or transform) are rebuilt by UpdateIndex().
+ * Also owns the FRoadLaneGraph of the registered splines for the routing, and the FRoadJunctionConflicts of the graph.
+ */
+UCLASS()
+class UNREALDRIVE_API URoadLaneIndexSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Called from URoadSplineComponent::OnRegister() / OnUnregister() */
+	void RegisterRoadSpline(const URoadSplineComponent* RoadSpline);
+	void UnregisterRoadSpline(const URoadSplineComponent* RoadSpline);
+
+	/** Rebuild the index of the changed road splines. Called automatically from ProjectPoints(). Game thread only */
+	void UpdateIndex();
+
+	/**
+	 * Find the road lanes under the world points. Points are evaluated in parallel.
+	 * If a point is over several lanes (e.g. in junctions), the lane with the smallest |Height| is returned.
+	 * @param MaxHeight - max distance of the point from the road surface
+	 */
+	void ProjectPoints(TConstArrayView<FVector> WorldPoints, TArrayView<FRoadLaneProjection> OutProjections, double MaxHeight = 200.0);
+
+	FRoadLaneProjection ProjectPoint(const FVector& WorldPoint, double MaxHeight = 200.0);
+
+	/** Lane graph of the registered road splines. Only the changed splines are rebuilt, the edges are relinked if any connection was changed. Game thread only */
+	const FRoadLaneGraph& GetLaneGraph();
+
+	/** See FRoadLaneGraph::FindRoute() */
+	bool FindRoute(const FRoadLaneLocation& Start, const FRoadLaneLocation& Goal, FRoadLaneRoute& OutRoute, bool bUseHeuristic = true);
+
+	/** Conflict zones of the junction lanes of GetLaneGraph(). Rebuilt only if the lane graph was changed. Game thread only */
+	const FRoadJunctionConflicts& GetJunctionConflicts();
+
+private:
+	struct FSlice
+	{
+		double S0;
+		double S1;
+	};
+
+	struct FRoadSplineEntry
+	{
+		TWeakObjectPtr<const URoadSplineComponent> WeakRoadSpline;
+
+		/** Valid after UpdateIndex(), used by the worker threads. Also the key of the entry in the EntryIndices, even if the spline is destroyed */
+		const URoadSplineComponent* RoadSpline = nullptr;
+
+		uint64 SplineCurvesVersion = 0;
+		uint64 LayoutVersion = 0;
+		FTransform Transform;
+		bool bIsDirty = true;
+
+		TArray<FSlice> Slices;
+		UnrealDrive::FBoxBVH SlicesBVH;
+	};
+
+	void BuildEntry(FRoadSplineEntry& Entry) const;
+	void RemoveEntryAtSwap(int EntryIndex);
+	FRoadLaneProjection ProjectPointInner(const FVector& WorldPoint, double MaxHeight) const;
+	static bool ProjectPointToSlice(const URoadSplineComponent* RoadSpline, const FSlice& Slice, const FVector& WorldPoint, double MaxHeight, FRoadLaneProjection& OutProjection);
+
+	TArray<FRoadSplineEntry> Entries;
+
+	/** Index of the entry in the Entries per registered road spline */
+	TMap<const URoadSplineComponent*, int> EntryIndices;
+	UnrealDrive::FBoxBVH EntriesBVH;
+	bool bEntriesBVHDirty = true;
+
+	FRoadLaneGraph LaneGraph;
+	FRoadJunctionConflicts JunctionConflicts;
+	bool bJunctionConflictsDirty = true;
+};
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 Ivan Zhukov. All Rights Reserved.
+ * Email: ivzhuk7@gmail.com
+ */
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AliasTable.h"
+#include "UnrealDriveTypes.h"
+
+class URoadSplineComponent;
+
+/**
+ * Lanes used by the FRoadLanePointSampler
+ */
+struct FRoadLanePointSamplerFilter
+{
+	/** FRoadLaneDriving lanes with these types are sampled */
+	TArray<EDriveableRoadLaneType> DriveableLaneTypes = { EDriveableRoadLaneType::Driving };
+
+	/** FRoadLaneSidewalk lanes are sampled */
+	bool bSidewalks = false;
+
+	/** The lane must have all these attributes (see FRoadLane::Attributes) */
+	TArray<FName> RequiredAttributes;
+
+	bool Matches(const FRoadLane& Lane) const;
+};
+
+/**
+ * Result of the FRoadLanePointSampler::Sample()
+ */
+struct FRoadLanePointSample
+{
+	const URoadSplineComponent* RoadSpline = nullptr;
+	int SectionIndex = INDEX_NONE; // Start section of the lane
+	int LaneIndex = LANE_INDEX_NONE;
+	double SOffset = 0;
+
+	/** World transform at the lane center, X axis is along the travel direction of the lane */
+	FTransform Transform;
+};
+
+/**
+ * Samples uniformly distributed points (by the lane length) on the lanes of the road splines, e.g. for the traffic spawning.
+ * Two level alias tables are used: the road splines weighted by the total length of the filtered lanes, and the lanes of each spline.
+ * So each sample is O(1), and only the tables of the changed splines are rebuilt by Update().
+ */
+class UNREALDRIVE_API FRoadLanePointSampler
+{
+public:
+	FRoadLanePointSampler() = default;
+	explicit FRoadLanePointSampler(const FRoadLanePointSamplerFilter& InFilter) : Filter(InFilter) {}
+
+	/** Changing the filter rebuilds all splines on the next Update() */
+	void SetFilter(const FRoadLanePointSamplerFilter& InFilter);
+	const FRoadLanePointSamplerFilter& GetFilter() const { return Filter; }
+
+	/**
+	 * Rebuild the lanes of the changed road splines (layout, attributes or spline curves version). Game thread only.
+	 * @return true if the sampler was changed
+	 */
+	bool Update(TConstArrayView<const URoadSplineComponent*> RoadSplines);
+
+	void Reset();
+
+	bool IsEmpty() const { return SplinesTable.IsEmpty(); }
+	double GetTotalLength() const { return SplinesTable.GetTotalWeight(); }
+
+	/** Append NumSamples random points to OutSamples. The transforms are evaluated with the batched URoadSplineComponent::GetRoadPositions() */
+	void Sample(FRandomStream& RandomStream, int NumSamples, TArray<FRoadLanePointSample>& OutSamples) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FLaneItem
+	{
+		int SectionIndex;
+		int LaneIndex;
+		double SOffset0;
+		double SOffset1;
+		bool bIsForward;
+	};
+
+	struct FSplineItem
+	{
+		uint64 SplineCurvesVersion = 0;
+		uint64 LayoutVersion = 0;
+		uint64 AttributesVersion = 0; // The filter may match the lane attributes
+		bool bIsBuilt = false;
+		TArray<FLaneItem> Lanes;
+		UnrealDrive::FAliasTable LanesTable;
+	};
+
+	void BuildSplineItem(const URoadSplineComponent* RoadSpline, FSplineItem& Item) const;
+
+	FRoadLanePointSamplerFilter Filter;
+	TMap<const URoadSplineComponent*, FSplineItem> SplineItems;
+
+	/** Order of the SplinesTable */
+	TArray<const URoadSplineComponent*> Splines;
+	TArray<const FSplineItem*> SplineItemPtrs;
+	UnrealDrive::FAliasTable SplinesTable;
+};
@@ -23,6 +23,11 @@ namespace UnrealDrive
 {
 	struct FTriProxy;
 	struct FLaneProxy;
+	struct FRoadMeshBuffers;
+	struct FRoadMeshData;
+
+	/** Forget the cached relevance of the road materials, must be called when the materials are recompiled or replaced */
+	void ResetMaterialRelevanceCache();
 }
 
 
@@ -93,7 +98,7 @@ class UNREALDRIVE_API FRoadSplineSceneProxy final : public FPrimitiveSceneProxy
 {
 
 public:
-	FRoadSplineSceneProxy(URoadSplineComponent* Component);
+	FRoadSplineSceneProxy(URoadSplineComponent* Component, TSharedPtr<const UnrealDrive::FRoadMeshData> InMeshData);
 	FRoadSplineSceneProxy(const FRoadSplineSceneProxy& Component) = delete;
 	virtual ~FRoadSplineSceneProxy();
 
@@ -101,23 +106,36 @@ public:
 	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override;
 	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override;
 	virtual bool CanBeOccluded() const override;
-	virtual uint32 GetMemoryFootprint(void) const override { return(sizeof(*this) + GetAllocatedSize()); }
+	/** Includes the GPU buffers of the lane meshes, so the memreports show the full cost of the road */
+	virtual uint32 GetMemoryFootprint(void) const override { return(sizeof(*this) + GetAllocatedSize() + GetGPUMemorySize()); }
 	virtual SIZE_T GetTypeHash() const override
 	{
 		static size_t UniquePointer;
 		return reinterpret_cast<size_t>(&UniquePointer);
 	}
 
-	uint32 GetAllocatedSize(void) const { return(FPrimitiveSceneProxy::GetAllocatedSize()); }
+	/** CPU memory of the proxy: the lane proxies, the lane meshes and the CPU copies of the lane buffers */
+	SIZE_T GetAllocatedSize(void) const { return(FPrimitiveSceneProxy::GetAllocatedSize() + LanesAllocatedSize); }
+
+	/** Video memory of the lane mesh buffers */
+	SIZE_T GetGPUMemorySize() const { return GPUMemorySize; }
 
 	virtual HHitProxy* CreateHitProxies(UPrimitiveComponent* Component, TArray<TRefCountPtr<HHitProxy> >& OutHitProxies) override;
 
 private:
+	/** The lane meshes are drawn by GetDynamicMeshElements() if their material depends on the selection state, otherwise they are static */
+	bool UseDynamicLaneMeshes() const;
+
 	URoadSplineComponent* RoadSpline = nullptr;
+	TSharedPtr<const UnrealDrive::FRoadMeshData> MeshData;
 	TArray<TSharedPtr<UnrealDrive::FLaneProxy>> LanesProxies;
+	TArray<TSharedPtr<UnrealDrive::FRoadMeshBuffers>> MeshBuffers;
 	TSharedPtr<UnrealDrive::FTriProxy> TriProxy;
 	FMaterialRelevance MaterialRelevance{};
-	bool bIsMultiRoad;
+	bool bIsMultiRoad = false;
+	bool bMergeLaneBatches = false;
+	SIZE_T LanesAllocatedSize = 0;
+	SIZE_T GPUMemorySize = 0;
 	//TArray<TPair<FVector, FVector>> ArrawLines;
 	const class UUnrealDriveSubsystem* Subsystem = nullptr;
 };
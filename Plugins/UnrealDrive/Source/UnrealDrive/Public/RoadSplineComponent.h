@@ -12,6 +12,11 @@
 
 struct FDriveSplineInstanceData;
 
+namespace UnrealDrive
+{
+	struct FRoadMeshData;
+}
+
 
 enum class EComputeArcMode
 {
@@ -94,6 +99,17 @@ struct FRoadPosition
 	*/
 };
 
+/**
+ * Query of the batched URoadSplineComponent::GetRoadPositions(), the same as the arguments of the GetRoadPosition(SectionIndex, LaneIndex, Alpha, SOffset)
+ */
+struct FRoadLanePositionQuery
+{
+	int SectionIndex = INDEX_NONE;
+	int LaneIndex = LANE_INDEX_NONE;
+	double Alpha = 0;
+	double SOffset = 0;
+};
+
 /** 
  * URoadSplineComponent
  */
@@ -151,6 +167,9 @@ public:
 	//UFUNCTION(BlueprintCallable, Category = Spline)
 	virtual void UpdateSpline(int EditingPointIndex);
 
+	/** Same as UpdateSpline(int), but fixes tangents around several edited points and rebuilds the spline once */
+	virtual void UpdateSpline(TConstArrayView<int> EditingPointIndices);
+
 	UFUNCTION(BlueprintCallable, Category = Road)
 	const FRoadLayout& GetRoadLayout() const { return RoadLayout; }
 	FRoadLayout& GetRoadLayout() { return RoadLayout; }
@@ -181,7 +200,8 @@ public:
 
 	void BuildOffsetCurves(double RightOffset, FSplineCurves& OutCurves) const;
 
-	void BuildLinearApproximation(TArray<FSplinePositionLinearApproximation>& OutPoints, const TFunction<double(double)>& RightOffsetFunc, double S0, double S1, int ReparamStepsPerSegment, int MinNumSteps, ESplineCoordinateSpace::Type CoordinateSpace) const;
+	/** @param OutSOffsets - optional distances along the spline of the OutPoints */
+	void BuildLinearApproximation(TArray<FSplinePositionLinearApproximation>& OutPoints, const TFunction<double(double)>& RightOffsetFunc, double S0, double S1, int ReparamStepsPerSegment, int MinNumSteps, ESplineCoordinateSpace::Type CoordinateSpace, TArray<double>* OutSOffsets = nullptr) const;
 
 	FVector EvalLanePoistion(int SectionIndex, int LaneIndex, double S, double Alpha, ESplineCoordinateSpace::Type CoordinateSpace) const;
 
@@ -204,6 +224,9 @@ public:
 
 	int FindRoadSectionOnSplineKey(float SplineKey) const;
 
+	/** Binary search of the section which contains SOffset. SOffset out of the spline is clamped to the first/last section */
+	int FindRoadSectionOnSOffset(double SOffset) const;
+
 	//void InsertSection(int SectionIndex, const FRoadLaneSection & Section);
 	//bool DeleteSection(int SectionIndex);
 	virtual int SplitSection(float SplineKey, ERoadLaneSectionSide Side);
@@ -233,10 +256,29 @@ public:
 
 	void VapidateConnections();
 
+#if WITH_EDITOR
+	/**
+	 * Lane meshes for the scene proxy. If the road was changed since the last build, the new build is started on a worker thread and the previous
+	 * mesh (or nullptr) is returned, the render state is recreated when the build is finished (see UnrealDrive.AsyncRoadMeshBuild).
+	 */
+	TSharedPtr<const UnrealDrive::FRoadMeshData> GetRoadMeshData();
+#endif
+
 public:
 	FRoadPosition GetRoadPosition(int SectionIndex, int LaneIndex, double Alpha, double SOffset, ESplineCoordinateSpace::Type CoordinateSpace) const;
 	FRoadPosition GetRoadPosition(double SOffset, double ROffset, ESplineCoordinateSpace::Type CoordinateSpace) const;
 
+	/**
+	 * Batched versions of the GetRoadPosition(). OutPositions[i] is the result of the i-th query.
+	 * The queries are evaluated in the ascending SOffset order, so the neighbouring queries continue the reparam table search from each other.
+	 * Large batches are split over the worker threads.
+	 */
+	void GetRoadPositions(TConstArrayView<FRoadLanePositionQuery> Queries, TArrayView<FRoadPosition> OutPositions, ESplineCoordinateSpace::Type CoordinateSpace) const;
+	void GetRoadPositions(TConstArrayView<double> SOffsets, TConstArrayView<double> ROffsets, TArrayView<FRoadPosition> OutPositions, ESplineCoordinateSpace::Type CoordinateSpace) const;
+
+protected:
+	void GetRoadPositionsInner(int NumQueries, TFunctionRef<double(int QueryIndex)> GetSOffset, TFunctionRef<double(int QueryIndex, double SOffset)> GetROffset, TArrayView<FRoadPosition> OutPositions, ESplineCoordinateSpace::Type CoordinateSpace) const;
+
 public:
 	virtual void UpdateSpline() override;
 	virtual void Serialize(FArchive& Ar) override;
@@ -249,6 +291,7 @@ protected:
 	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport = ETeleportType::None) override;
 #if WITH_EDITOR
 	virtual void PostEditChangeChainProperty(FPropertyChangedChainEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
 #endif
 	virtual void PostLoad() override;
 	virtual void PostInitProperties() override;
@@ -275,12 +318,46 @@ protected:
 
 	virtual void MagicUpdateTransformInner(TFunction<bool(const URoadSplineComponent*)> Filter);
 
+	/** 
+	 * Fast path of UpdateSpline() for edits of a few neighbouring points. 
+	 * Recomputes tangents and reparam table entries of the adjacent segments only and shifts the rest of the reparam table.
+	 * @return false if the edit isn't local (or can't be detected), so the full update is required
+	 */
+	bool UpdateSplinePartial();
+
+	/** Remember SplineCurves state after the full UpdateSpline() */
+	void UpdateSplineSnapshot();
+
 protected:
 	UPROPERTY();
 	URoadSplineMetadata* SplineMetadata = nullptr;
 
 	int SelectedSectionIndex = INDEX_NONE;
 	int SelectedLaneSectionIndex = 0;
+
+private:
+	/** SplineCurves points at the last UpdateSpline(), used by UpdateSplinePartial() to find the edited points */
+	struct FSplineUpdateSnapshot
+	{
+		TArray<FInterpCurvePointVector> Position;
+		TArray<FInterpCurvePointQuat> Rotation;
+		TArray<FInterpCurvePointVector> Scale;
+		TArray<ERoadSplinePointTypeOverride> PointTypes;
+		FVector Scale3D = FVector::ZeroVector;
+		int ReparamStepsPerSegment = 0;
+		bool bStationaryEndpoints = false;
+		bool bIsValid = false;
+	};
+	FSplineUpdateSnapshot SplineUpdateSnapshot;
+
+#if WITH_EDITOR
+	/** Build the lane meshes from a transient copy of this road on a worker thread. Game thread only */
+	void StartRoadMeshBuild();
+
+	TSharedPtr<const UnrealDrive::FRoadMeshData> RoadMeshData;
+	FCriticalSection RoadMeshDataLock;
+	bool bRoadMeshBuildInFlight = false;
+#endif
 };
 
 
@@ -22,4 +22,8 @@ public:
 
 private:
 	static bool bIsRoadSplinesVisibleInEditor;
+
+#if WITH_EDITOR
+	FDelegateHandle MaterialCompilationFinishedHandle;
+#endif
 };
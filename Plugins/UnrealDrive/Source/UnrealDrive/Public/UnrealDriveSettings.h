@@ -67,6 +67,14 @@ public:
 	UPROPERTY(EditAnywhere, config, Category = LookAndFeel, AdvancedDisplay, meta = (ClampMin = "2", ClampMax = "100"))
 	int NumPointPerSection = 20;
 
+	/** Max deviation [cm] of the LOD1 lane meshes from the full lane meshes, multiplied by 4 for each next LOD */
+	UPROPERTY(EditAnywhere, config, Category = LookAndFeel, AdvancedDisplay, meta = (ClampMin = "0.1", ClampMax = "1000"))
+	float LaneMeshLODError = 5.0f;
+
+	/** Max screen sizes of the LOD1, LOD2, LOD3 of the lane meshes (only the first 3 are used), empty to draw the full lane meshes only */
+	UPROPERTY(EditAnywhere, config, Category = LookAndFeel, AdvancedDisplay, meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	TArray<float> LaneMeshLODScreenSizes = { 0.3f, 0.1f, 0.03f };
+
 
 public:
 	TMap<EDriveableRoadLaneType, TObjectPtr<UMaterialInstanceDynamic>> DriveableLaneMatrtials;
@@ -6,11 +6,14 @@
 #pragma once
 
 #include "Subsystems/WorldSubsystem.h"
+#include "BoxBVH.h"
+#include "UObject/ObjectKey.h"
 #include "UnrealDriveSubsystem.generated.h"
 
 class URoadConnection;
 class URoadSplineComponent;
 class ULaneConnection;
+struct FConvexVolume;
 
 UCLASS()
 class UNREALDRIVE_API UUnrealDriveSubsystem : public UTickableWorldSubsystem
@@ -47,17 +50,47 @@ public:
 		float OrthoWorldCoordinateWidth;
 	};
 
+	/** Called from URoadSplineComponent::OnRegister() / OnUnregister() */
+	void RegisterRoadSpline(const URoadSplineComponent* RoadSpline);
+	void UnregisterRoadSpline(const URoadSplineComponent* RoadSpline);
+
+	/** @return true if the Actor has more than one registered road spline. The road splines of the actor are redrawn when it changes */
+	bool IsMultiRoadActor(const AActor* Actor) const
+	{
+		const int* NumRoadSplines = NumActorRoadSplines.Find(Actor);
+		return NumRoadSplines && *NumRoadSplines > 1;
+	}
+
+	/** Rebuild the connections index of the changed road splines (spline curves, layout version or transform). Called automatically from CaptureConnections() */
+	void UpdateConnectionsIndex();
+
+	struct FObservedConnection
+	{
+		TWeakObjectPtr<const URoadSplineComponent> RoadSpline;
+		TWeakObjectPtr<const ULaneConnection> Connection;
+		FConnectionInfo Info;
+	};
+
 	void UpdateObservedConnections(const URoadSplineComponent* RoadSpline);
 	void CleanObservedConnections();
 	void AddObservedConnections(const URoadSplineComponent* RoadSpline, const TArray<const ULaneConnection*>& Connections);
-	auto GetObservedConnections() const { return ObservedConnections; }
+
+	/** Flat view of the observed connections, grouped by the road spline. The pointers may be stale, see ForEachObservedConnection() */
+	TConstArrayView<FObservedConnection> GetObservedConnections() const { return ObservedConnections; }
 	/**
 	 * @param MaxViewDistance - valid only if bIsOrthographic is false
 	 * @params OrthoWorldCoordinateWidth - Current width of viewport in world space coordinates. Only valid if bIsOrthographic is true
+	 * Only the connections of the indexed road splines inside the view frustum and MaxViewDistance are visited.
 	 */
 	void CaptureConnections(const URoadConnection* SrcConnection, const FViewCameraState& CameraState,  double MaxViewDistance, double MaxOrthoWidth, TFunction<bool(const ULaneConnection*)> IsConnectionAllowed = [](const ULaneConnection*) { return true; });
-	void ForEachObservedConnection(TFunctionRef<void(const ULaneConnection*, FConnectionInfo&)> VisitorFunc);
-	TPair<TWeakObjectPtr<const ULaneConnection>, FConnectionInfo>* FindObservedConnectionByPredicate(TFunctionRef<bool (const ULaneConnection*, const FConnectionInfo&) > VisitorFunc);
+
+	/**
+	 * Visit the valid observed connections without copying them.
+	 * @param ViewFrustum - if set, only the connections inside the frustum are visited
+	 * @param RoadSpline - if set, only the connections of this road spline are visited
+	 */
+	void ForEachObservedConnection(TFunctionRef<void(const ULaneConnection*, FConnectionInfo&)> VisitorFunc, const FConvexVolume* ViewFrustum = nullptr, const URoadSplineComponent* RoadSpline = nullptr);
+	FConnectionInfo* FindObservedConnectionByPredicate(TFunctionRef<bool (const ULaneConnection*, const FConnectionInfo&) > VisitorFunc);
 
 	bool GetRoadSplineWasSelected() const { return bRoadSplineWasSelected; }
 
@@ -67,11 +100,59 @@ private:
 
 	void OnDuplicateActorsBegin();
 	void OnDuplicateActorsEnd();
+	void OnCopyActorsBegin();
+	void OnPasteActorsBegin();
+
+	/** Give new GUIDs to the lane connections of the RoadSplines and store the GUIDs of the connected lanes in their road connections */
+	static void AssignConnectionGuids(TConstArrayView<URoadSplineComponent*> RoadSplines);
+	static void GetSelectedRoadSplines(TArray<URoadSplineComponent*>& OutRoadSplines);
 
 	bool bDuplicationStarted = false;
 	TArray<AActor*> DuplicatedActors;
 
-	TMap<TWeakObjectPtr<const URoadSplineComponent>, TMap<TWeakObjectPtr<const ULaneConnection>, FConnectionInfo>> ObservedConnections;
+	TArray<FObservedConnection> ObservedConnections;
+
+	/** Index of the observed connection in the ObservedConnections, so the connections of one road spline are updated without the full scan */
+	TMap<TObjectKey<ULaneConnection>, int> ObservedConnectionIndices;
+
+	void AddObservedConnection(const URoadSplineComponent* RoadSpline, const ULaneConnection* Connection, const FConnectionInfo& Info);
+
+	struct FIndexedConnection
+	{
+		/** The connections may be replaced without a version bump (e.g. undo of a lane edit), so the stale ones are skipped */
+		TWeakObjectPtr<const ULaneConnection> Connection;
+		FTransform Transform; // [world]
+	};
+
+	struct FConnectionsEntry
+	{
+		TWeakObjectPtr<const URoadSplineComponent> WeakRoadSpline;
+
+		/** Key of the entry in the ConnectionsEntryIndices, never dereferenced */
+		const URoadSplineComponent* RoadSpline = nullptr;
+
+		uint64 SplineCurvesVersion = 0;
+		uint64 LayoutVersion = 0;
+		FTransform Transform;
+		bool bIsDirty = true;
+
+		TArray<FIndexedConnection> Connections;
+		FBox Bounds{ ForceInit };
+	};
+
+	void BuildConnectionsEntry(const URoadSplineComponent* RoadSpline, FConnectionsEntry& Entry) const;
+	void RemoveConnectionsEntryAtSwap(int EntryIndex);
+
+	/** Lane connections of the registered road splines, the entries are kept in the BVH by the bounds of their connections */
+	TArray<FConnectionsEntry> ConnectionsEntries;
+
+	/** Index of the entry in the ConnectionsEntries per registered road spline */
+	TMap<const URoadSplineComponent*, int> ConnectionsEntryIndices;
+	UnrealDrive::FBoxBVH ConnectionsBVH;
+	bool bConnectionsBVHDirty = true;
+
+	/** Number of the registered road splines per owner actor, see IsMultiRoadActor() */
+	TMap<TObjectKey<AActor>, int> NumActorRoadSplines;
 
 	bool bRoadSplineWasSelected = false;
 #endif
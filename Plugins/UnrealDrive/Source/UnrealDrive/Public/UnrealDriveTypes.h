@@ -12,6 +12,7 @@
 #include "StructUtils/InstancedStruct.h"
 #include "Animation/AttributeCurve.h"
 #include "RoadLaneAttribute.h"
+#include "CompiledCurve.h"
 #include "UnrealDriveTypes.generated.h"
 
 enum { LANE_INDEX_NONE = 0 };
@@ -22,6 +23,8 @@ namespace UnrealDrive
 	const static double DefaultRoadLaneWidth = 375.0;
 	
 	UNREALDRIVE_API void TrimCurveInRang(FRichCurve& Curve, double Time0, double Time1, bool bFitBorders);
+
+	struct FLaneWidthPrefixTable;
 };
 
 class URoadSplineComponent;
@@ -259,6 +262,8 @@ private:
 	UPROPERTY(VisibleAnywhere, Category = RoadLane, Transient)
 	int LaneIndex = LANE_INDEX_NONE;
 
+	/** Width compiled from FRoadLayout::CompileCurves() */
+	UnrealDrive::FCompiledCurve CompiledWidth;
 
 public:
 	bool IsLaneValid() const;
@@ -277,6 +282,15 @@ public:
 	double GetStartOffset() const;
 	double GetEndOffset() const { return SOffsetEnd_Cashed; }
 
+	/** 
+	 * Evaluate Width using the compiled curve.
+	 * @param LocalSOffset - SOffset from the start section of this lane
+	 */
+	double EvalWidth(double LocalSOffset) const { return CompiledWidth.Eval(Width, LocalSOffset); }
+
+	/** The same as EvalWidth(LocalSOffset), but the compiled span search starts from InOutSpanHint */
+	double EvalWidth(double LocalSOffset, int& InOutSpanHint) const { return CompiledWidth.Eval(Width, LocalSOffset, InOutSpanHint); }
+
 	/** Fit Width and Attributes to lane section bounds */
 	void Trim(bool bFitWidth);
 };
@@ -361,6 +375,12 @@ private:
 	/** Set from FRoadLayout::UpdateLayout() */
 	UPROPERTY(VisibleAnywhere, Category = LaneSection, Transient)
 	int SectionIndex = INDEX_NONE; 
+
+	/** 
+	 * Cumulative lane widths sampled along the section, used by EvalLaneROffset().
+	 * Built lazily and invalidated by FRoadLayout::GetLayoutVersion(). Never copied between sections.
+	 */
+	TSharedRef<UnrealDrive::FLaneWidthPrefixTable, ESPMode::ThreadSafe> WidthPrefixTable;
 };
 
 /**
@@ -410,6 +430,7 @@ struct UNREALDRIVE_API FRoadLayout
 	void TrimSections(double SplineLength, double Tolerance, URoadSplineComponent* OwnedRoadSpline);
 
 	double EvalROffset(double S) const;
+	double EvalROffset(double S, int& InOutSpanHint) const;
 
 	int FindSideSection(int SectionIndex, ERoadLaneSectionSide Side) const;
 
@@ -417,11 +438,18 @@ struct UNREALDRIVE_API FRoadLayout
 	uint64 GetAttributesVersion() const { return AttributesVersion; }
 
 	void UpdateAttributesVersion() { ++AttributesVersion; }
-	void UpdateLayoutVersion() { ++LayoutVersion; }
+
+	/** Must be called after any changes of the lanes width or ROffset */
+	void UpdateLayoutVersion();
 
 private:
+	/** Rebuild compiled Width of all lanes and ROffset */
+	void CompileCurves();
+
 	TSharedPtr<FRoadLayout*> ThisShared;
 
+	UnrealDrive::FCompiledCurve CompiledROffset;
+
 	uint64 LayoutVersion = 0;
 	uint64 AttributesVersion = 0;
 };
@@ -488,6 +516,9 @@ public:
 
 	static int32 GlobalTransformMagic;
 
+	/** Incremented each time any road connection is connected or disconnected. Used to invalidate the caches built from the connections (e.g. FRoadLaneGraph) */
+	static uint32 ConnectionsVersion;
+
 private:
 	/** Used to prevent recursive SetTransform() */
 	mutable int32 TransformMagic = 0;
@@ -673,7 +673,7 @@ void FRoadSplineComponentVisualizer::DrawVisualization(const UActorComponent* Co
 				SDPG_Foreground);
 
 			PDI->SetHitProxy(nullptr);
-		});
+		}, &View->ViewFrustum);
 	}
 	/*
 	else if (SplineComp->OwnerIsJunction() && !bIsSelectedInViewport)
@@ -1581,7 +1581,7 @@ bool FRoadSplineComponentVisualizer::TransformSelectedKeys(EPropertyChangeType::
 					SplineComp->SetRotationAtSplinePoint_Fixed(LastKeyIndexSelected, Transform.GetRotation().Rotator(), ESplineCoordinateSpace::World, false);
 					SplinePosition.Points[LastKeyIndexSelected].ArriveTangent = SplinePosition.Points[LastKeyIndexSelected].ArriveTangent.GetSafeNormal() * CashedConnectionArrivalTangent.Size();
 					SplinePosition.Points[LastKeyIndexSelected].LeaveTangent = SplinePosition.Points[LastKeyIndexSelected].LeaveTangent.GetSafeNormal() * CashedConnectionLeaveTangent.Size();
-					Info->Value.bIsSelected = true;
+					Info->bIsSelected = true;
 					SelectionState->SetCachedRotation(SplineComp->GetQuaternionAtSplinePoint(LastKeyIndexSelected, ESplineCoordinateSpace::World));
 				}
 			}
@@ -1464,7 +1464,7 @@ void UDrawRoadTool::Render(IToolsContextRenderAPI* RenderAPI)
 				SDPG_Foreground);
 
 			PDI->SetHitProxy(nullptr);
-		});
+		}, &RenderAPI->GetSceneView()->ViewFrustum);
 	}
 }
 
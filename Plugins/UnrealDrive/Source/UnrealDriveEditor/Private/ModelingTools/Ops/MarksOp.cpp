@@ -377,14 +377,13 @@ void FMarksOp::CalculateResult(FProgressCancel* Progress)
 			const auto& Section = LanePoly->GetSection();
 			if (const auto* FoundAttribute = LanePoly->GetLaneAttributes().Find(UnrealDrive::LaneAttributes::Mark))
 			{
-				for (int AttributeIndex = 0; AttributeIndex < FoundAttribute->Keys.Num(); ++AttributeIndex)
+				FoundAttribute->ForEachSpanInRange(0.0, LanePoly->GetEndOffset() - Section.SOffset, [&](int KeyIndex, double SpanS0, double SpanS1)
 				{
-					const auto& MarkKey = FoundAttribute->Keys[AttributeIndex];
-					const auto& MarkValue = MarkKey.GetValue<FRoadLaneMark>();
+					const auto& MarkValue = FoundAttribute->Keys[KeyIndex].GetValue<FRoadLaneMark>();
 					if (!MarkValue.ProfileName.IsNone())
 					{
-						const double SOffsetStart = MarkKey.SOffset + Section.SOffset;
-						const double SOffsetEnd = (AttributeIndex < FoundAttribute->Keys.Num() - 1) ? FoundAttribute->Keys[AttributeIndex + 1].SOffset + Section.SOffset : LanePoly->GetEndOffset();
+						const double SOffsetStart = SpanS0 + Section.SOffset;
+						const double SOffsetEnd = SpanS1 + Section.SOffset;
 
 						auto& LineVertices = LanePoly->LaneIndex == 0 ? LanePoly->InsideLineVertices : LanePoly->OutsideLineVertices;
 						if (ensure(LineVertices.Num()))
@@ -398,7 +397,7 @@ void FMarksOp::CalculateResult(FProgressCancel* Progress)
 							}
 						}
 					}
-				}
+				});
 			}
 		}
 
@@ -422,7 +422,7 @@ void FSplineMeshOp::CalculateResult(FProgressCancel* Progress)
 					}
 				}
 
-				for (int AttributeIndex = 0; AttributeIndex < AttributeEntry.Keys.Num(); ++AttributeIndex)
+				AttributeEntry.ForEachSpanInRange(0.0, LanePoly->GetEndOffset() - Section.SOffset, [&](int AttributeIndex, double SpanS0, double SpanS1)
 				{
 					const auto* KeyStart = &AttributeEntry.Keys[AttributeIndex];
 					const auto* ValueStart = KeyStart->GetValuePtr<FRoadLaneGeneration>();
@@ -432,8 +432,8 @@ void FSplineMeshOp::CalculateResult(FProgressCancel* Progress)
 						const auto* KeyEnd = (AttributeIndex < AttributeEntry.Keys.Num() - 1) ? &AttributeEntry.Keys[AttributeIndex + 1] : nullptr;
 						const auto* ValueEnd = KeyEnd ? KeyEnd->GetValuePtr<FRoadLaneGeneration>() : nullptr;
 
-						const double SOffsetStart = KeyStart->SOffset + Section.SOffset;
-						const double SOffsetEnd = KeyEnd ? KeyEnd->SOffset + Section.SOffset : LanePoly->GetEndOffset();
+						const double SOffsetStart = SpanS0 + Section.SOffset;
+						const double SOffsetEnd = SpanS1 + Section.SOffset;
 						//const double MaxSquareDistanceFromSpline = 2.0;
 
 						FRoadLanePolylineSplineMesh Polyline;
@@ -446,7 +446,7 @@ void FSplineMeshOp::CalculateResult(FProgressCancel* Progress)
 							Arrangemen.Insert(MoveTemp(Polyline), ArrangemenTolerance);
 						}
 					}
-				}
+				});
 			}
 		}
 
@@ -38,6 +38,9 @@
 #include "ModelingTools/DrawRoadTool.h"
 #include "ModelingTools/OpFactories.h"
 #include "Widgets/Input/SHyperlink.h"
+#include "BakedRoadNetwork.h"
+#include "Editor.h"
+#include "UObject/ObjectSaveContext.h"
 
 #define LOCTEXT_NAMESPACE "FUnrealDriveEditorModule"
 
@@ -72,6 +75,7 @@ void FUnrealDriveEditorModule::StartupModule()
 
 	FCoreDelegates::OnPostEngineInit.AddRaw(this, &FUnrealDriveEditorModule::OnPostEngineInit);
 	FCoreDelegates::OnEnginePreExit.AddRaw(this, &FUnrealDriveEditorModule::OnPreExit);
+	FEditorDelegates::PreSaveWorldWithContext.AddRaw(this, &FUnrealDriveEditorModule::OnPreSaveWorld);
 }
 
 void FUnrealDriveEditorModule::ShutdownModule()
@@ -85,6 +89,7 @@ void FUnrealDriveEditorModule::ShutdownModule()
 
 	FCoreDelegates::OnPostEngineInit.RemoveAll(this);
 	FCoreDelegates::OnEnginePreExit.RemoveAll(this);
+	FEditorDelegates::PreSaveWorldWithContext.RemoveAll(this);
 
 	//PropertyModule.UnregisterCustomPropertyTypeLayout("RoadLaneAttributeProfile");
 }
@@ -104,6 +109,15 @@ void FUnrealDriveEditorModule::OnPostEngineInit()
 
 }
 
+void FUnrealDriveEditorModule::OnPreSaveWorld(UWorld* World, FObjectPreSaveContext ObjectSaveContext)
+{
+	const UUnrealDriveEditorSettings* Settings = GetDefault<UUnrealDriveEditorSettings>();
+	if (World && ObjectSaveContext.IsCooking() && Settings->bBakeRoadNetworkOnCook)
+	{
+		FRoadNetworkBaker::BakeWorld(World, Settings->BakedRoadNetworkSampleStep);
+	}
+}
+
 void FUnrealDriveEditorModule::OnPreExit()
 {
 	RoadLaneAttributEntries.Empty();
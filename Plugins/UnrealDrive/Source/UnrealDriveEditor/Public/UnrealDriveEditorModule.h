@@ -15,6 +15,8 @@
 //#include "UnrealDriveEditorModule.generated.h"
 
 class FUICommandList;
+class FObjectPreSaveContext;
+class UWorld;
 
 //class FRoadSectionComponentVisualizer;
 //class FRoadSplineComponentVisualizer;
@@ -95,6 +97,7 @@ protected:
 	void RegisterRoadComputeFactories();
 	void OnPreExit();
 	void OnPostEngineInit();
+	void OnPreSaveWorld(UWorld* World, FObjectPreSaveContext ObjectSaveContext);
 
 	void SetComponentVisualizer(TSharedRef<FComponentVisualizer> Visualizer);
 
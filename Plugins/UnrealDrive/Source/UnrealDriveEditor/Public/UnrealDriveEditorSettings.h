@@ -75,6 +75,14 @@ public:
 	UPROPERTY(EditAnywhere, config, Category = LookAndFeel, AdvancedDisplay, meta = (ClampMin = "100.0", ClampMax = "200000.0"))
 	double RoadConnectionMaxViewOrthoWidth = 50000.0;
 
+	/** Bake the road network of each cooked world to Content/UnrealDrive/BakedRoadNetworks (see FBakedRoadNetwork). Add this directory to DirectoriesToAlwaysStageAsNonUFS to memory map it at runtime */
+	UPROPERTY(EditAnywhere, config, Category = Cook)
+	bool bBakeRoadNetworkOnCook = false;
+
+	/** Distance between the centre line samples of the baked road network */
+	UPROPERTY(EditAnywhere, config, Category = Cook, meta = (ClampMin = "10.0", ClampMax = "10000.0", EditCondition = "bBakeRoadNetworkOnCook"))
+	double BakedRoadNetworkSampleStep = 100.0;
+
 	const UMaterialInstanceDynamic* GetLaneConnectionMaterialDyn() const;
 	const UMaterialInstanceDynamic* GetLaneConnectionSelectedMaterialDyn() const;
 